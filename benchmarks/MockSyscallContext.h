@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef MOD_SHARED3P_EMU_BENCHMARKS_MOCKSYSCALLCONTEXT_H
+#define MOD_SHARED3P_EMU_BENCHMARKS_MOCKSYSCALLCONTEXT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <sharemind/module-apis/api_0x1.h>
+#include <type_traits>
+#include <vector>
+
+
+namespace sharemind {
+
+/**
+ * A syscall context standing in for the VM. It hands out a single PDPI for
+ * protection domain index 0, has no process facilities (so the profiler is
+ * never used) and keeps the public memory of the "process" in its own
+ * buffers.
+ */
+class MockSyscallContext {
+
+public: /* Methods: */
+
+    inline MockSyscallContext(void * moduleHandle, void * pdpiHandle)
+        : m_context()
+        , m_pdpiHandle(pdpiHandle)
+    {
+        m_context.moduleHandle = moduleHandle;
+        m_context.get_pd_process_instance_handle = &getPdpiHandle;
+        m_context.processFacility = &processFacility;
+        m_context.publicAlloc = &publicAlloc;
+        m_context.publicFree = &publicFree;
+        m_context.publicMemPtrSize = &publicMemPtrSize;
+        m_context.publicMemPtrData = &publicMemPtrData;
+    }
+
+    MockSyscallContext(const MockSyscallContext &) = delete;
+    MockSyscallContext & operator=(const MockSyscallContext &) = delete;
+
+    inline SharemindModuleApi0x1SyscallContext * context() noexcept
+    { return &m_context; }
+
+private: /* Methods: */
+
+    static inline MockSyscallContext & self(
+            const SharemindModuleApi0x1SyscallContext * c) noexcept
+    {
+        static_assert(std::is_standard_layout<MockSyscallContext>::value, "");
+        return *reinterpret_cast<MockSyscallContext *>(
+                const_cast<SharemindModuleApi0x1SyscallContext *>(c));
+    }
+
+    static void * getPdpiHandle(SharemindModuleApi0x1SyscallContext * c,
+                                uint64_t pdIndex)
+    { return pdIndex == 0u ? self(c).m_pdpiHandle : nullptr; }
+
+    static void * processFacility(const SharemindModuleApi0x1SyscallContext *,
+                                  const char *)
+    { return nullptr; }
+
+    /* Public memory handles are indexes into m_publicMemory plus one. */
+
+    static uint64_t publicAlloc(SharemindModuleApi0x1SyscallContext * c,
+                                uint64_t nBytes)
+    {
+        try {
+            auto & memory = self(c).m_publicMemory;
+            memory.emplace_back(nBytes);
+            return memory.size();
+        } catch (...) {
+            return 0u;
+        }
+    }
+
+    static bool publicFree(SharemindModuleApi0x1SyscallContext * c,
+                           uint64_t ptr)
+    {
+        auto & memory = self(c).m_publicMemory;
+        if (ptr == 0u || ptr > memory.size())
+            return false;
+
+        std::vector<char>().swap(memory[ptr - 1u]);
+        return true;
+    }
+
+    static size_t publicMemPtrSize(SharemindModuleApi0x1SyscallContext * c,
+                                   uint64_t ptr)
+    {
+        auto & memory = self(c).m_publicMemory;
+        return (ptr == 0u || ptr > memory.size()) ? 0u : memory[ptr - 1u].size();
+    }
+
+    static void * publicMemPtrData(SharemindModuleApi0x1SyscallContext * c,
+                                   uint64_t ptr)
+    {
+        auto & memory = self(c).m_publicMemory;
+        return (ptr == 0u || ptr > memory.size())
+               ? nullptr
+               : memory[ptr - 1u].data();
+    }
+
+private: /* Fields: */
+
+    /* Must stay the first field, the callbacks cast the context back. */
+    SharemindModuleApi0x1SyscallContext m_context;
+    void * const m_pdpiHandle;
+    std::vector<std::vector<char> > m_publicMemory;
+
+}; /* class MockSyscallContext { */
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_BENCHMARKS_MOCKSYSCALLCONTEXT_H */
@@ -0,0 +1,594 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+/*
+ * Times the syscalls of the module without a VM. The syscalls are taken from
+ * the definitions table of the module and called through a mock syscall
+ * context on a single process instance of a protection domain set up from a
+ * normal configuration file.
+ *
+ * The argument layout of a syscall is not recorded anywhere, so it is
+ * discovered on small vectors: the benchmark tries the layouts of the
+ * elementwise, reduction and public operand syscalls with the types named in
+ * the syscall name and uses the first one the syscall accepts. Syscalls which
+ * do not fit any of these layouts are reported as unsupported.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <LogHard/Backend.h>
+#include <LogHard/Logger.h>
+#include <LogHard/StdAppender.h>
+#include <map>
+#include <memory>
+#include <sharemind/module-apis/api_0x1.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/Shared3pModule.h"
+#include "../src/Shared3pPD.h"
+#include "../src/Shared3pPDPI.h"
+#include "MockSyscallContext.h"
+
+
+extern "C" {
+extern SharemindModuleApi0x1SyscallDefinitions const
+        sharemindModuleApi0x1SyscallDefinitions;
+} // extern "C" {
+
+namespace sharemind {
+
+namespace {
+
+using SyscallFunction = SharemindModuleApi0x1Error (*)(
+        SharemindCodeBlock *,
+        size_t,
+        const SharemindModuleApi0x1Reference *,
+        const SharemindModuleApi0x1CReference *,
+        SharemindCodeBlock *,
+        SharemindModuleApi0x1SyscallContext *);
+
+/* Vector sizes used while discovering the argument layout: */
+constexpr size_t DISCOVERY_SIZE = 4u;
+
+/* The largest number of vector handles after the pd index: */
+constexpr size_t MAX_HANDLES = 4u;
+
+/* Element widths tried for public operands: */
+constexpr size_t NUM_PUBLIC_WIDTHS = 4u;
+constexpr size_t PUBLIC_WIDTHS[NUM_PUBLIC_WIDTHS] = { 1u, 2u, 4u, 8u };
+
+/* Type names as they appear in syscall names, longer names first: */
+const char * const TYPE_NAMES[] = {
+    "xor_uint8", "xor_uint16", "xor_uint32", "xor_uint64",
+    "uint8", "uint16", "uint32", "uint64",
+    "int8", "int16", "int32", "int64",
+    "float32", "float64",
+    "fix32", "fix64",
+    "bool"
+};
+
+struct Options {
+    std::string configuration = SHARED3P_EMU_BENCHMARK_CONFIGURATION;
+    std::string output;
+    std::string filter;
+    bool json = false;
+    uint64_t minSize = 1u;
+    uint64_t maxSize = 100000000u;
+    double minTime = 0.1;
+    double maxCallTime = 10.0;
+};
+
+/** The argument layout of a syscall. */
+struct Layout {
+    std::vector<std::string> types; // vector types of the handle arguments
+    bool scalarResult = false;      // the last vector has a single element
+    size_t publicWidth = 0u;        // element width of a public operand or 0
+    bool publicIsRef = false;       // the public operand is written to
+    bool returnValue = false;
+
+    std::string str() const {
+        std::ostringstream oss;
+        for (size_t i = 0u; i < types.size(); ++i)
+            oss << (i ? " " : "") << types[i]
+                << ((scalarResult && i + 1u == types.size()) ? "[1]" : "");
+        if (publicWidth)
+            oss << (publicIsRef ? " ref" : " cref") << publicWidth;
+        if (returnValue)
+            oss << " ret";
+        return oss.str();
+    }
+};
+
+struct Measurement {
+    std::string syscall;
+    std::string layout;
+    uint64_t size;
+    const char * status;
+    uint64_t iterations;
+    double secondsPerCall;
+};
+
+/** \returns the type names in the given syscall name in order. */
+std::vector<std::string> typesInName(const std::string & name) {
+    std::vector<std::string> types;
+    size_t pos = 0u;
+    while (pos < name.size()) {
+        if (pos == 0u || name[pos - 1u] == '_' || name[pos - 1u] == ':') {
+            bool found = false;
+            for (const char * const type : TYPE_NAMES) {
+                const size_t len = std::strlen(type);
+                if (name.compare(pos, len, type) == 0
+                    && (pos + len == name.size() || name[pos + len] == '_'))
+                {
+                    types.emplace_back(type);
+                    pos += len;
+                    found = true;
+                    break;
+                }
+            }
+            if (found)
+                continue;
+        }
+        ++pos;
+    }
+    return types;
+}
+
+class SyscallBenchmark {
+
+public: /* Methods: */
+
+    SyscallBenchmark(MockSyscallContext & context, const Options & options)
+        : m_context(context)
+        , m_options(options)
+    {
+        for (const SharemindModuleApi0x1SyscallDefinition * d =
+                 sharemindModuleApi0x1SyscallDefinitions;
+             d->signature && d->signature[0u] != '\0';
+             ++d)
+        {
+            m_names.emplace_back(d->signature);
+            m_syscalls.emplace(d->signature, d->fptr);
+        }
+    }
+
+    std::vector<Measurement> run() {
+        std::vector<Measurement> measurements;
+        for (const std::string & name : m_names) {
+            if (name.find(m_options.filter) == std::string::npos)
+                continue;
+
+            const std::string shortName = name.substr(name.find("::") + 2u);
+            if (shortName.compare(0u, 4u, "new_") == 0
+                || shortName.compare(0u, 7u, "delete_") == 0)
+            {
+                measurements.push_back({ name, "", 0u, "skipped", 0u, 0.0 });
+                continue;
+            }
+
+            Layout layout;
+            if (!discover(m_syscalls[name], typesInName(shortName), layout)) {
+                measurements.push_back({ name, "", 0u, "unsupported", 0u, 0.0 });
+                continue;
+            }
+
+            measure(name, layout, measurements);
+        }
+        return measurements;
+    }
+
+private: /* Methods: */
+
+    SyscallFunction find(const std::string & shortName) const {
+        const auto it = m_syscalls.find("shared3p::" + shortName);
+        return it == m_syscalls.end() ? nullptr : it->second;
+    }
+
+    SharemindModuleApi0x1Error call(SyscallFunction f,
+                                    SharemindCodeBlock * args,
+                                    size_t argc,
+                                    std::vector<char> * publicData,
+                                    bool publicIsRef,
+                                    bool returnValue)
+    {
+        SharemindModuleApi0x1Reference refs[2u];
+        SharemindModuleApi0x1CReference crefs[2u];
+        refs[1u].pData = nullptr;
+        refs[1u].size = 0u;
+        crefs[1u].pData = nullptr;
+        crefs[1u].size = 0u;
+        if (publicData) {
+            refs[0u].pData = publicData->data();
+            refs[0u].size = publicData->size();
+            crefs[0u].pData = publicData->data();
+            crefs[0u].size = publicData->size();
+        }
+
+        SharemindCodeBlock retVal;
+        retVal.uint64[0u] = 0u;
+        return f(args,
+                 argc,
+                 (publicData && publicIsRef) ? refs : nullptr,
+                 (publicData && !publicIsRef) ? crefs : nullptr,
+                 returnValue ? &retVal : nullptr,
+                 m_context.context());
+    }
+
+    /** \returns a handle to a new vector filled with nonzero values. */
+    void * newVector(const std::string & type, uint64_t size) {
+        SharemindCodeBlock args[3u];
+        args[0u].uint64[0u] = 0u;
+        args[1u].uint64[0u] = size;
+
+        SharemindCodeBlock retVal;
+        retVal.p[0u] = nullptr;
+        const SyscallFunction newVec = find("new_" + type + "_vec");
+        if (!newVec
+            || newVec(args, 2u, nullptr, nullptr, &retVal, m_context.context())
+               != SHAREMIND_MODULE_API_0x1_OK
+            || !retVal.p[0u])
+            return nullptr;
+
+        void * const handle = retVal.p[0u];
+        if (const SyscallFunction randomize =
+                find("randomize_" + type + "_vec"))
+        {
+            args[1u].p[0u] = handle;
+            if (call(randomize, args, 2u, nullptr, false, false)
+                    == SHAREMIND_MODULE_API_0x1_OK)
+                return handle;
+        } else if (const SyscallFunction init = find("init_" + type + "_vec")) {
+            // Use one, the bit patterns of the float types are spelled out:
+            if (type == "float32")
+                args[1u].uint64[0u] = 0x3f800000u;
+            else if (type == "float64")
+                args[1u].uint64[0u] = 0x3ff0000000000000u;
+            else
+                args[1u].uint64[0u] = 1u;
+            args[2u].p[0u] = handle;
+            if (call(init, args, 3u, nullptr, false, false)
+                    == SHAREMIND_MODULE_API_0x1_OK)
+                return handle;
+        }
+
+        deleteVector(type, handle);
+        return nullptr;
+    }
+
+    void deleteVector(const std::string & type, void * handle) {
+        if (const SyscallFunction deleteVec = find("delete_" + type + "_vec")) {
+            SharemindCodeBlock args[2u];
+            args[0u].uint64[0u] = 0u;
+            args[1u].p[0u] = handle;
+            call(deleteVec, args, 2u, nullptr, false, false);
+        }
+    }
+
+    /** Public operands hold ones of the given width. */
+    static std::vector<char> publicData(size_t width, uint64_t size) {
+        std::vector<char> data(width * size, 0);
+        for (size_t i = 0u; i < data.size(); i += width)
+            data[i] = 1;
+        return data;
+    }
+
+    /** Vectors for one call with the given layout, deleted afterwards. */
+    class Arguments {
+
+    public: /* Methods: */
+
+        Arguments(SyscallBenchmark & benchmark,
+                  const Layout & layout,
+                  uint64_t size)
+            : m_benchmark(benchmark)
+            , m_layout(layout)
+            , m_args(1u + layout.types.size())
+        {
+            m_args[0u].uint64[0u] = 0u;
+            for (size_t i = 0u; i < layout.types.size(); ++i) {
+                const bool scalar =
+                        layout.scalarResult && i + 1u == layout.types.size();
+                void * const handle =
+                        benchmark.newVector(layout.types[i], scalar ? 1u : size);
+                if (!handle)
+                    return;
+
+                m_args[i + 1u].p[0u] = handle;
+                ++m_created;
+            }
+
+            if (layout.publicWidth)
+                m_publicData = publicData(layout.publicWidth, size);
+        }
+
+        ~Arguments() {
+            for (size_t i = 0u; i < m_created; ++i)
+                m_benchmark.deleteVector(m_layout.types[i],
+                                         m_args[i + 1u].p[0u]);
+        }
+
+        bool valid() const noexcept
+        { return m_created == m_layout.types.size(); }
+
+        SharemindModuleApi0x1Error call(SyscallFunction f) {
+            return m_benchmark.call(f,
+                                    m_args.data(),
+                                    m_args.size(),
+                                    m_layout.publicWidth ? &m_publicData
+                                                         : nullptr,
+                                    m_layout.publicIsRef,
+                                    m_layout.returnValue);
+        }
+
+    private: /* Fields: */
+
+        SyscallBenchmark & m_benchmark;
+        const Layout & m_layout;
+        std::vector<SharemindCodeBlock> m_args;
+        std::vector<char> m_publicData;
+        size_t m_created = 0u;
+
+    }; /* class Arguments { */
+
+    /** Tries the layouts on small vectors until the syscall accepts one. */
+    bool discover(SyscallFunction f,
+                  std::vector<std::string> candidates,
+                  Layout & layout)
+    {
+        candidates.emplace_back("bool");
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                         candidates.end());
+
+        for (size_t handles = 1u; handles <= MAX_HANDLES; ++handles) {
+            // No public operand, then constant and mutable ones:
+            for (size_t pub = 0u; pub <= 2u * NUM_PUBLIC_WIDTHS; ++pub) {
+                layout.publicWidth =
+                        pub ? PUBLIC_WIDTHS[(pub - 1u) % NUM_PUBLIC_WIDTHS] : 0u;
+                layout.publicIsRef = pub > NUM_PUBLIC_WIDTHS;
+                for (int flags = 0; flags < 4; ++flags) {
+                    layout.scalarResult = flags & 1;
+                    layout.returnValue = flags & 2;
+
+                    // Every assignment of the candidate types to the handles:
+                    std::vector<size_t> digits(handles, 0u);
+                    do {
+                        layout.types.clear();
+                        for (const size_t d : digits)
+                            layout.types.push_back(candidates[d]);
+
+                        Arguments arguments(*this, layout, DISCOVERY_SIZE);
+                        if (arguments.valid()
+                            && arguments.call(f) == SHAREMIND_MODULE_API_0x1_OK)
+                            return true;
+                    } while (nextDigits(digits, candidates.size()));
+                }
+            }
+        }
+
+        return false;
+    }
+
+    static bool nextDigits(std::vector<size_t> & digits, size_t base) {
+        for (size_t & d : digits) {
+            if (++d < base)
+                return true;
+            d = 0u;
+        }
+        return false;
+    }
+
+    void measure(const std::string & name,
+                 const Layout & layout,
+                 std::vector<Measurement> & measurements)
+    {
+        using Clock = std::chrono::steady_clock;
+        const SyscallFunction f = m_syscalls[name];
+        const std::string layoutStr = layout.str();
+
+        for (uint64_t size = m_options.minSize;; size *= 10u) {
+            Arguments arguments(*this, layout, size);
+            if (!arguments.valid()) {
+                measurements.push_back(
+                        { name, layoutStr, size, "alloc_failed", 0u, 0.0 });
+                return;
+            }
+
+            // The first call also warms up the caches and the vector pool:
+            Clock::time_point start = Clock::now();
+            if (arguments.call(f) != SHAREMIND_MODULE_API_0x1_OK) {
+                measurements.push_back(
+                        { name, layoutStr, size, "error", 0u, 0.0 });
+                return;
+            }
+            double elapsed =
+                    std::chrono::duration<double>(Clock::now() - start).count();
+            if (elapsed >= m_options.maxCallTime) {
+                measurements.push_back(
+                        { name, layoutStr, size, "ok", 1u, elapsed });
+                return;
+            }
+
+            uint64_t iterations = 1u;
+            for (;;) {
+                start = Clock::now();
+                for (uint64_t i = 0u; i < iterations; ++i)
+                    arguments.call(f);
+                elapsed = std::chrono::duration<double>(
+                            Clock::now() - start).count();
+                if (elapsed >= m_options.minTime)
+                    break;
+
+                // Aim a bit over the minimum time with the next round:
+                const double scale = elapsed > 0.0
+                                     ? 1.5 * m_options.minTime / elapsed
+                                     : 10.0;
+                iterations = std::max(iterations + 1u,
+                                      static_cast<uint64_t>(
+                                          iterations * std::min(scale, 10.0)));
+            }
+
+            measurements.push_back({ name, layoutStr, size, "ok", iterations,
+                                     elapsed / iterations });
+            if (size > m_options.maxSize / 10u)
+                return;
+        }
+    }
+
+private: /* Fields: */
+
+    MockSyscallContext & m_context;
+    const Options & m_options;
+    std::vector<std::string> m_names;
+    std::map<std::string, SyscallFunction> m_syscalls;
+
+}; /* class SyscallBenchmark { */
+
+void writeCsv(std::ostream & os, const std::vector<Measurement> & ms) {
+    os << "syscall,layout,size,status,iterations,ns_per_call,ns_per_element\n";
+    for (const Measurement & m : ms) {
+        const double ns = m.secondsPerCall * 1e9;
+        os << m.syscall << ',' << m.layout << ',' << m.size << ','
+           << m.status << ',' << m.iterations << ',' << ns << ','
+           << (m.size ? ns / m.size : 0.0) << '\n';
+    }
+}
+
+void writeJson(std::ostream & os, const std::vector<Measurement> & ms) {
+    os << "[\n";
+    for (size_t i = 0u; i < ms.size(); ++i) {
+        const Measurement & m = ms[i];
+        const double ns = m.secondsPerCall * 1e9;
+        os << "  {\"syscall\": \"" << m.syscall
+           << "\", \"layout\": \"" << m.layout
+           << "\", \"size\": " << m.size
+           << ", \"status\": \"" << m.status
+           << "\", \"iterations\": " << m.iterations
+           << ", \"ns_per_call\": " << ns
+           << ", \"ns_per_element\": " << (m.size ? ns / m.size : 0.0)
+           << (i + 1u < ms.size() ? "},\n" : "}\n");
+    }
+    os << "]\n";
+}
+
+void usage(const char * program) {
+    std::cerr
+        << "Usage: " << program << " [options]\n"
+           "  --config FILE       protection domain configuration\n"
+           "                      (" SHARED3P_EMU_BENCHMARK_CONFIGURATION ")\n"
+           "  --filter STRING     only syscalls whose name contains STRING\n"
+           "  --format csv|json   output format (csv)\n"
+           "  --output FILE       write the results to FILE instead of stdout\n"
+           "  --min-size N        smallest vector size (1)\n"
+           "  --max-size N        largest vector size, sizes grow tenfold "
+           "(100000000)\n"
+           "  --min-time SECONDS  minimum measured time per size (0.1)\n"
+           "  --max-call-time SECONDS\n"
+           "                      larger sizes are skipped once a single call "
+           "takes this long (10)\n";
+}
+
+bool parseOptions(int argc, char * argv[], Options & options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (i + 1 >= argc)
+            return false;
+
+        const char * const value = argv[++i];
+        if (arg == "--config") {
+            options.configuration = value;
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--format") {
+            if (std::strcmp(value, "json") == 0)
+                options.json = true;
+            else if (std::strcmp(value, "csv") == 0)
+                options.json = false;
+            else
+                return false;
+        } else if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--min-size") {
+            options.minSize = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--max-size") {
+            options.maxSize = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--min-time") {
+            options.minTime = std::strtod(value, nullptr);
+        } else if (arg == "--max-call-time") {
+            options.maxCallTime = std::strtod(value, nullptr);
+        } else {
+            return false;
+        }
+    }
+    return options.minSize > 0u && options.minSize <= options.maxSize;
+}
+
+} /* anonymous namespace */
+
+} /* namespace sharemind { */
+
+int main(int argc, char * argv[]) {
+    using namespace sharemind;
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto backend(std::make_shared<LogHard::Backend>());
+    backend->addAppender(std::make_shared<LogHard::StdAppender>());
+    const LogHard::Logger logger(backend);
+
+    try {
+        Shared3pModule module(logger);
+        Shared3pPD pd("shared3p", options.configuration, module);
+        Shared3pPDPI pdpi(pd);
+        MockSyscallContext context(&module, &pdpi);
+
+        const std::vector<Measurement> measurements =
+                SyscallBenchmark(context, options).run();
+
+        std::ofstream file;
+        if (!options.output.empty()) {
+            file.open(options.output);
+            if (!file) {
+                std::cerr << "Failed to open " << options.output << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        std::ostream & os = options.output.empty() ? std::cout : file;
+        if (options.json)
+            writeJson(os, measurements);
+        else
+            writeCsv(os, measurements);
+        return EXIT_SUCCESS;
+    } catch (...) {
+        logger.printCurrentException();
+        return EXIT_FAILURE;
+    }
+}
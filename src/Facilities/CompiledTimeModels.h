@@ -0,0 +1,351 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef MOD_SHARED3P_EMU_COMPILEDTIMEMODELS_H
+#define MOD_SHARED3P_EMU_COMPILEDTIMEMODELS_H
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sharemind/ExecutionModelEvaluator.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace sharemind {
+
+/**
+ * \brief A time model of the form max(a, b * S ^ c) * k or a * k.
+ *
+ * Computes the same operations as ExecutionModelEvaluator in the same order,
+ * but without interpreting the expression. Sizes for which the power term
+ * cannot exceed the constant skip the pow().
+ */
+class __attribute__ ((visibility("internal"))) CompiledTimeModel {
+
+public: /* Methods: */
+
+    /** A constant model a * k. */
+    inline CompiledTimeModel(double a, double k) noexcept
+        : m_a(a)
+        , m_b(0.0)
+        , m_c(1.0)
+        , m_k(k)
+        , m_constant(true)
+        , m_constantEnd(0u)
+        , m_constantValue(a * k)
+    {}
+
+    /** The model max(a, b * S ^ c) * k. */
+    inline CompiledTimeModel(double a, double b, double c, double k) noexcept
+        : m_a(a)
+        , m_b(b)
+        , m_c(c)
+        , m_k(k)
+        , m_constant(false)
+        , m_constantEnd(0u)
+        , m_constantValue(a * k)
+    {
+        // The power term is increasing only for these, find the first size
+        // where it exceeds a with the same pow() as evaluate() uses:
+        if (!(b > 0.0) || !(c > 0.0) || !(a >= 0.0))
+            return;
+
+        uint64_t lo = 0u; // b * pow(lo, c) <= a
+        uint64_t hi = uint64_t(1u) << 53u;
+        if (powerTerm(hi) <= a) {
+            m_constantEnd = hi;
+            return;
+        }
+
+        while (hi - lo > 1u) {
+            const uint64_t mid = lo + (hi - lo) / 2u;
+            if (powerTerm(mid) <= a) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        m_constantEnd = hi;
+    }
+
+    inline double evaluate(size_t parameter) const noexcept {
+        if (m_constant || parameter < m_constantEnd)
+            return m_constantValue;
+
+        return std::max(m_a, powerTerm(parameter)) * m_k;
+    }
+
+    /** Sizes below this skip the pow(). */
+    inline uint64_t constantEnd() const noexcept { return m_constantEnd; }
+
+private: /* Methods: */
+
+    inline double powerTerm(uint64_t size) const noexcept
+    { return m_b * std::pow(static_cast<double>(size), m_c); }
+
+private: /* Fields: */
+
+    double m_a;
+    double m_b;
+    double m_c;
+    double m_k;
+    bool m_constant;
+    /** Sizes below this evaluate to m_constantValue. */
+    uint64_t m_constantEnd;
+    double m_constantValue;
+
+}; /* class CompiledTimeModel { */
+
+/**
+ * \brief The time models of a model evaluator configuration which have one of
+ *        the forms of CompiledTimeModel. Other models are left to the model
+ *        evaluator.
+ *
+ * The configuration is parsed separately from the model evaluator, so the
+ * compiled models are only used after verify() has compared them with the
+ * models of the evaluator.
+ */
+class __attribute__ ((visibility("internal"))) CompiledTimeModels {
+
+public: /* Methods: */
+
+    /** Reads the [TimeModel] section of the given configuration file. */
+    explicit CompiledTimeModels(const std::string & filename) {
+        std::ifstream in(filename);
+        std::string section;
+        std::string variable;
+        std::vector<std::pair<std::string, std::string> > models;
+        for (std::string line; std::getline(in, line);) {
+            line = trim(line);
+            if (line.empty() || line.front() == ';' || line.front() == '#')
+                continue;
+
+            if (line.front() == '[') {
+                section = line;
+                continue;
+            }
+
+            const size_t eq = line.find('=');
+            if (eq == std::string::npos)
+                continue;
+
+            std::string key(trim(line.substr(0u, eq)));
+            std::string value(trim(line.substr(eq + 1u)));
+            if (section == "[BaseVariable]" && key == "InputSize") {
+                variable = std::move(value);
+            } else if (section == "[TimeModel]") {
+                models.emplace_back(std::move(key), std::move(value));
+            }
+        }
+
+        for (const auto & m : models) {
+            Parser parser(m.second, variable);
+            if (!variable.empty() && parser.parse())
+                m_models.emplace(m.first, parser.model());
+        }
+    }
+
+    /**
+     * \brief Drops the compiled models which the evaluator does not have or
+     *        which give a different result than the evaluator for any of a
+     *        set of sizes, including the ones around constantEnd().
+     * \returns the number of dropped models.
+     */
+    size_t verify(ExecutionModelEvaluator & evaluator) {
+        static const uint64_t sizes[] = {
+            0u, 1u, 2u, 3u, 7u, 10u, 100u, 1000u, 4096u, 65536u, 1000000u,
+            1000000000u, uint64_t(1u) << 40u
+        };
+
+        size_t dropped = 0u;
+        for (auto it = m_models.begin(); it != m_models.end();) {
+            ExecutionModelEvaluator::Model * const model =
+                    evaluator.model("TimeModel", it->first.c_str());
+            const CompiledTimeModel & compiled = it->second;
+            const auto same = [model, &compiled](uint64_t size) {
+                return compiled.evaluate(size) == model->evaluate(size);
+            };
+
+            const uint64_t end = compiled.constantEnd();
+            const bool matches = model
+                    && std::all_of(std::begin(sizes), std::end(sizes), same)
+                    && (end == 0u || (same(end - 1u) && same(end)
+                                      && same(end + 1u)));
+            if (matches) {
+                ++it;
+            } else {
+                it = m_models.erase(it);
+                ++dropped;
+            }
+        }
+
+        return dropped;
+    }
+
+    /** \returns the compiled model of the syscall or nullptr if none. */
+    inline const CompiledTimeModel * model(const char * name) const {
+        const auto it = m_models.find(name);
+        return it == m_models.end() ? nullptr : &it->second;
+    }
+
+private: /* Types: */
+
+    /**
+     * Recognizes max(a, b * S ^ c) * k, max(a, b * S) * k and a * k, the
+     * trailing * k being optional.
+     */
+    class Parser {
+
+    public: /* Methods: */
+
+        Parser(const std::string & expression, const std::string & variable)
+            : m_expression(expression)
+            , m_variable(variable)
+        {}
+
+        bool parse() {
+            double k = 1.0;
+            if (name("max")) {
+                double a;
+                double b;
+                double c = 1.0;
+                if (!(symbol('(') && number(a) && symbol(',') && number(b)
+                      && symbol('*') && name(m_variable.c_str())))
+                    return false;
+                if (symbol('^') && !number(c))
+                    return false;
+                if (!symbol(')'))
+                    return false;
+                if (symbol('*') && !number(k))
+                    return false;
+                if (!end())
+                    return false;
+
+                m_model = CompiledTimeModel(a, b, c, k);
+                return true;
+            }
+
+            double a;
+            if (!number(a))
+                return false;
+            if (symbol('*') && !number(k))
+                return false;
+            if (!end())
+                return false;
+
+            m_model = CompiledTimeModel(a, k);
+            return true;
+        }
+
+        const CompiledTimeModel & model() const noexcept { return m_model; }
+
+    private: /* Methods: */
+
+        void skipSpace() {
+            while (m_pos < m_expression.size()
+                   && std::isspace(static_cast<unsigned char>(
+                                       m_expression[m_pos])))
+                ++m_pos;
+        }
+
+        bool end() {
+            skipSpace();
+            return m_pos == m_expression.size();
+        }
+
+        bool symbol(char c) {
+            skipSpace();
+            if (m_pos == m_expression.size() || m_expression[m_pos] != c)
+                return false;
+            ++m_pos;
+            return true;
+        }
+
+        bool name(const char * n) {
+            skipSpace();
+            const std::string s(n);
+            if (m_expression.compare(m_pos, s.size(), s) != 0)
+                return false;
+
+            // The name must not continue:
+            const size_t after = m_pos + s.size();
+            if (after < m_expression.size()
+                && (std::isalnum(static_cast<unsigned char>(
+                                     m_expression[after]))
+                    || m_expression[after] == '_'))
+                return false;
+
+            m_pos = after;
+            return true;
+        }
+
+        bool number(double & value) {
+            skipSpace();
+            if (m_pos == m_expression.size()
+                || !(std::isdigit(static_cast<unsigned char>(
+                                      m_expression[m_pos]))
+                     || m_expression[m_pos] == '.'))
+                return false;
+
+            const char * const begin = m_expression.c_str() + m_pos;
+            char * end;
+            value = std::strtod(begin, &end);
+            if (end == begin)
+                return false;
+
+            m_pos += static_cast<size_t>(end - begin);
+            return true;
+        }
+
+    private: /* Fields: */
+
+        const std::string & m_expression;
+        const std::string & m_variable;
+        size_t m_pos = 0u;
+        CompiledTimeModel m_model{0.0, 0.0};
+
+    }; /* class Parser { */
+
+private: /* Methods: */
+
+    static std::string trim(const std::string & s) {
+        const auto notSpace = [](char c)
+                { return !std::isspace(static_cast<unsigned char>(c)); };
+        const auto begin = std::find_if(s.begin(), s.end(), notSpace);
+        const auto end = std::find_if(s.rbegin(), s.rend(), notSpace).base();
+        return begin < end ? std::string(begin, end) : std::string();
+    }
+
+private: /* Fields: */
+
+    std::unordered_map<std::string, CompiledTimeModel> m_models;
+
+}; /* class CompiledTimeModels { */
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_COMPILEDTIMEMODELS_H */
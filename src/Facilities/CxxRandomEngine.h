@@ -20,17 +20,42 @@
 #ifndef MOD_SHARED3P_EMU_CXXRANDOMENGINE_H
 #define MOD_SHARED3P_EMU_CXXRANDOMENGINE_H
 
+#include <algorithm>
 #include <cassert>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <random>
 
 namespace sharemind {
 
+/**
+ * \brief Block oriented random number generator.
+ *
+ * Randomness is produced as the AES-256 keystream in counter mode, keyed and
+ * initialized from std::random_device. Crypto++ buffers the keystream
+ * internally, so consecutive requests of any size continue the same stream
+ * and large requests are filled many blocks at a time (using AES-NI where
+ * the CPU supports it).
+ */
 class CxxRandomEngine {
+
+private: /* Types: */
+
+    using Cipher = CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption;
+
 public: /* Methods: */
 
-    inline CxxRandomEngine() {
-        std::random_device rd;
-        m_rng.seed(rd());
+    inline CxxRandomEngine()
+        : m_cipher(new Cipher())
+    {
+        uint8_t key[CryptoPP::AES::MAX_KEYLENGTH];
+        uint8_t iv[CryptoPP::AES::BLOCKSIZE];
+        seedBytes(key, sizeof(key));
+        seedBytes(iv, sizeof(iv));
+        m_cipher->SetKeyWithIV(key, sizeof(key), iv, sizeof(iv));
     }
 
     CxxRandomEngine(const CxxRandomEngine &) = delete;
@@ -39,10 +64,10 @@ public: /* Methods: */
     CxxRandomEngine & operator=(CxxRandomEngine && other) = default;
 
     void fillBytes(void * memptr, size_t size) noexcept {
+        assert(m_cipher);
         auto mem = static_cast<uint8_t *>(memptr);
-        for (size_t i = 0; i < size; ++i) {
-            mem[i] = m_dist(m_rng);
-        }
+        std::memset(mem, 0, size);
+        m_cipher->ProcessData(mem, mem, size);
     }
 
     template <typename T>
@@ -60,9 +85,19 @@ public: /* Methods: */
         return value;
     }
 
+private: /* Methods: */
+
+    static void seedBytes(uint8_t * mem, size_t size) {
+        std::random_device rd;
+        using R = std::random_device::result_type;
+        for (size_t i = 0; i < size; i += sizeof(R)) {
+            const R r = rd();
+            std::memcpy(mem + i, &r, std::min(sizeof(R), size - i));
+        }
+    }
+
 private: /* Fields: */
-    std::default_random_engine m_rng;
-    std::uniform_int_distribution<uint8_t> m_dist;
+    std::unique_ptr<Cipher> m_cipher;
 
 }; /* class CxxRandomEngine { */
 
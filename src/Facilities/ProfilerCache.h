@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef MOD_SHARED3P_EMU_PROFILERCACHE_H
+#define MOD_SHARED3P_EMU_PROFILERCACHE_H
+
+#include <cstdint>
+#include <sharemind/ExecutionModelEvaluator.h>
+#include <sharemind/ExecutionProfiler.h>
+#include <sharemind/module-apis/api_0x1.h>
+#include <unordered_map>
+#include "CompiledTimeModels.h"
+
+namespace sharemind {
+
+/**
+ * \brief Per process cache of the profiler facility, profiler section types
+ *        and time models of syscalls.
+ */
+class ProfilerCache {
+
+public: /* Types: */
+
+    struct Entry {
+        uint32_t sectionTypeId;
+        const CompiledTimeModel * compiledTimeModel;
+        ExecutionModelEvaluator::Model * timeModel;
+
+        inline bool hasTimeModel() const noexcept
+        { return compiledTimeModel || timeModel; }
+
+        /** \pre hasTimeModel() */
+        inline double evaluateTime(size_t parameter) const {
+            return compiledTimeModel
+                   ? compiledTimeModel->evaluate(parameter)
+                   : timeModel->evaluate(parameter);
+        }
+    };
+
+public: /* Methods: */
+
+    inline ProfilerCache(ExecutionModelEvaluator & evaluator,
+                         const CompiledTimeModels & compiledModels) noexcept
+        : m_evaluator(evaluator)
+        , m_compiledModels(compiledModels)
+    {}
+
+    ProfilerCache(const ProfilerCache &) = delete;
+    ProfilerCache & operator=(const ProfilerCache &) = delete;
+
+    /**
+     * \returns the profiler of the process or nullptr if there is none. The
+     *          facility is only looked up on the first call.
+     */
+    inline ExecutionProfiler * profiler(
+            SharemindModuleApi0x1SyscallContext * ctx) noexcept
+    {
+        if (!m_profilerResolved) {
+            m_profiler = static_cast<ExecutionProfiler *>(
+                    ctx->processFacility(ctx, "Profiler"));
+            m_profilerResolved = true;
+        }
+
+        return m_profiler;
+    }
+
+    /**
+     * \pre profiler() has returned a profiler.
+     * \param[in] name syscall name with static storage duration, entries are
+     *                 keyed by its address.
+     */
+    inline const Entry & entry(const char * name) {
+        if (name == m_lastName)
+            return *m_lastEntry;
+
+        auto it = m_entries.find(name);
+        if (it == m_entries.end()) {
+            const CompiledTimeModel * const compiled =
+                    m_compiledModels.model(name);
+            const Entry e = { m_profiler->newSectionType(name),
+                              compiled,
+                              compiled ? nullptr
+                                       : m_evaluator.model("TimeModel", name) };
+            it = m_entries.emplace(name, e).first;
+        }
+
+        m_lastName = name;
+        m_lastEntry = &it->second;
+        return it->second;
+    }
+
+private: /* Fields: */
+
+    ExecutionModelEvaluator & m_evaluator;
+    const CompiledTimeModels & m_compiledModels;
+    ExecutionProfiler * m_profiler = nullptr;
+    bool m_profilerResolved = false;
+    std::unordered_map<const char *, Entry> m_entries;
+    const char * m_lastName = nullptr;
+    const Entry * m_lastEntry = nullptr;
+
+}; /* class ProfilerCache { */
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_PROFILERCACHE_H */
@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef MOD_SHARED3P_EMU_SYSCALLSTATISTICS_H
+#define MOD_SHARED3P_EMU_SYSCALLSTATISTICS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MOD_SHARED3P_EMU_SYSCALL_STATISTICS_TSC 1
+#endif
+
+namespace sharemind {
+
+/**
+ * \brief Per process counters of the wall-clock cost of syscalls.
+ *
+ * For every syscall the number of calls and the number of elements processed
+ * are counted, and every sampleInterval-th call is timed into a histogram of
+ * latencies. The histogram has 16 linear buckets for every power of two of
+ * ticks, so percentiles are accurate to 1/16. On x86 the ticks are read from
+ * the time stamp counter, which is much cheaper than reading the clock, and
+ * converted to nanoseconds when the statistics are written.
+ */
+class __attribute__ ((visibility("internal"))) SyscallStatistics {
+
+public: /* Types: */
+
+    enum class Format { None, Json, Csv };
+
+private: /* Types: */
+
+    static constexpr unsigned SUB_BUCKET_BITS = 4u;
+    static constexpr size_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr size_t NUM_BUCKETS =
+            (64u - SUB_BUCKET_BITS + 1u) * SUB_BUCKETS;
+
+    struct Entry {
+        uint64_t calls = 0u;
+        uint64_t elements = 0u;
+        uint64_t timedCalls = 0u;
+        uint64_t timedTicks = 0u;
+        uint64_t maxTicks = 0u;
+        std::array<uint64_t, NUM_BUCKETS> histogram{};
+    };
+
+public: /* Methods: */
+
+    inline SyscallStatistics(Format format, size_t sampleInterval) noexcept
+        : m_format(format)
+        , m_sampleInterval(sampleInterval != 0u ? sampleInterval : 1u)
+        , m_startTicks(now())
+        , m_startTime(std::chrono::steady_clock::now())
+    {}
+
+    SyscallStatistics(const SyscallStatistics &) = delete;
+    SyscallStatistics & operator=(const SyscallStatistics &) = delete;
+
+    inline bool enabled() const noexcept { return m_format != Format::None; }
+    inline Format format() const noexcept { return m_format; }
+    inline bool empty() const noexcept { return m_entries.empty(); }
+
+    /** \returns the current time in ticks. */
+    static inline uint64_t now() noexcept {
+#ifdef MOD_SHARED3P_EMU_SYSCALL_STATISTICS_TSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /** \returns whether the next syscall should be timed. */
+    inline bool sampleNext() noexcept {
+        if (m_sampleCountdown != 0u) {
+            --m_sampleCountdown;
+            return false;
+        }
+
+        m_sampleCountdown = m_sampleInterval - 1u;
+        return true;
+    }
+
+    /** \brief Sets the number of elements of the syscall being recorded. */
+    inline void setElements(uint64_t elements) noexcept
+    { m_pendingElements = elements; }
+
+    /**
+     * \brief Records a call which was not timed.
+     * \param[in] name syscall name with static storage duration, entries are
+     *                 keyed by its address.
+     */
+    inline void record(const char * name) {
+        Entry & e = entry(name);
+        ++e.calls;
+        e.elements += m_pendingElements;
+        m_pendingElements = 0u;
+    }
+
+    /** \brief Records a call which took the given number of ticks. */
+    inline void record(const char * name, uint64_t ticks) {
+        Entry & e = entry(name);
+        ++e.calls;
+        e.elements += m_pendingElements;
+        m_pendingElements = 0u;
+
+        ++e.timedCalls;
+        e.timedTicks += ticks;
+        if (ticks > e.maxTicks)
+            e.maxTicks = ticks;
+        ++e.histogram[bucket(ticks)];
+    }
+
+    /**
+     * \brief Writes the statistics in the format given on construction. The
+     *        total time of a syscall is estimated from its timed calls.
+     */
+    void write(std::ostream & os) const {
+        const double nsPerTick = nanosecondsPerTick();
+        const auto ns = [nsPerTick](double ticks)
+                { return static_cast<uint64_t>(ticks * nsPerTick + 0.5); };
+
+        // Sorted by name for stable output:
+        std::map<std::string, const Entry *> sorted;
+        for (const auto & p : m_entries)
+            sorted.emplace(p.first, p.second.get());
+
+        if (m_format == Format::Csv) {
+            os << "syscall,calls,elements,timed_calls,total_ns,mean_ns,"
+                  "p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n";
+            for (const auto & p : sorted) {
+                const Entry & e = *p.second;
+                const double mean = meanTicks(e);
+                os << p.first << ',' << e.calls << ',' << e.elements << ','
+                   << e.timedCalls << ',' << ns(mean * e.calls) << ','
+                   << ns(mean) << ',' << ns(percentile(e, 500u)) << ','
+                   << ns(percentile(e, 900u)) << ','
+                   << ns(percentile(e, 990u)) << ','
+                   << ns(percentile(e, 999u)) << ',' << ns(e.maxTicks)
+                   << '\n';
+            }
+            return;
+        }
+
+        os << "{\n  \"syscalls\": [";
+        bool first = true;
+        for (const auto & p : sorted) {
+            const Entry & e = *p.second;
+            const double mean = meanTicks(e);
+            os << (first ? "\n" : ",\n")
+               << "    {\n"
+               << "      \"name\": \"" << p.first << "\",\n"
+               << "      \"calls\": " << e.calls << ",\n"
+               << "      \"elements\": " << e.elements << ",\n"
+               << "      \"timedCalls\": " << e.timedCalls << ",\n"
+               << "      \"totalNs\": " << ns(mean * e.calls) << ",\n"
+               << "      \"meanNs\": " << ns(mean) << ",\n"
+               << "      \"p50Ns\": " << ns(percentile(e, 500u)) << ",\n"
+               << "      \"p90Ns\": " << ns(percentile(e, 900u)) << ",\n"
+               << "      \"p99Ns\": " << ns(percentile(e, 990u)) << ",\n"
+               << "      \"p999Ns\": " << ns(percentile(e, 999u)) << ",\n"
+               << "      \"maxNs\": " << ns(e.maxTicks) << ",\n"
+               << "      \"histogram\": [";
+            bool firstBucket = true;
+            for (size_t i = 0u; i < NUM_BUCKETS; ++i) {
+                if (e.histogram[i] == 0u)
+                    continue;
+                os << (firstBucket ? "" : ", ") << '[' << ns(lowerBound(i))
+                   << ", " << e.histogram[i] << ']';
+                firstBucket = false;
+            }
+            os << "]\n    }";
+            first = false;
+        }
+        os << "\n  ]\n}\n";
+    }
+
+private: /* Methods: */
+
+    inline Entry & entry(const char * name) {
+        if (name == m_lastName)
+            return *m_lastEntry;
+
+        auto it = m_entries.find(name);
+        if (it == m_entries.end())
+            it = m_entries.emplace(name, std::make_unique<Entry>()).first;
+
+        m_lastName = name;
+        m_lastEntry = it->second.get();
+        return *m_lastEntry;
+    }
+
+    static inline size_t bucket(uint64_t ticks) noexcept {
+        if (ticks < SUB_BUCKETS)
+            return ticks;
+
+        const unsigned exponent = 63u - __builtin_clzll(ticks);
+        const size_t sub = (ticks >> (exponent - SUB_BUCKET_BITS))
+                           & (SUB_BUCKETS - 1u);
+        return (exponent - SUB_BUCKET_BITS + 1u) * SUB_BUCKETS + sub;
+    }
+
+    static inline uint64_t lowerBound(size_t bucket) noexcept {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+
+        const unsigned exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1u;
+        const uint64_t sub = bucket % SUB_BUCKETS;
+        return (SUB_BUCKETS + sub) << (exponent - SUB_BUCKET_BITS);
+    }
+
+    static double meanTicks(const Entry & e) noexcept {
+        return e.timedCalls != 0u
+               ? static_cast<double>(e.timedTicks) / e.timedCalls
+               : 0.0;
+    }
+
+    /** \returns the lower bound of the bucket of the given per mille. */
+    static uint64_t percentile(const Entry & e, uint64_t perMille) noexcept {
+        const uint64_t rank = (e.timedCalls * perMille + 999u) / 1000u;
+        uint64_t seen = 0u;
+        for (size_t i = 0u; i < NUM_BUCKETS; ++i) {
+            seen += e.histogram[i];
+            if (seen >= rank && seen != 0u)
+                return lowerBound(i);
+        }
+        return e.maxTicks;
+    }
+
+    /** \returns the length of a tick measured over the life of the process. */
+    double nanosecondsPerTick() const noexcept {
+#ifdef MOD_SHARED3P_EMU_SYSCALL_STATISTICS_TSC
+        const uint64_t ticks = now() - m_startTicks;
+        const auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+        const double ns = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    elapsed).count());
+        return ticks != 0u ? ns / ticks : 1.0;
+#else
+        return 1.0;
+#endif
+    }
+
+private: /* Fields: */
+
+    const Format m_format;
+    const size_t m_sampleInterval;
+    const uint64_t m_startTicks;
+    const std::chrono::steady_clock::time_point m_startTime;
+    size_t m_sampleCountdown = 0u;
+    uint64_t m_pendingElements = 0u;
+    std::unordered_map<const char *, std::unique_ptr<Entry> > m_entries;
+    const char * m_lastName = nullptr;
+    Entry * m_lastEntry = nullptr;
+
+}; /* class SyscallStatistics { */
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_SYSCALLSTATISTICS_H */
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef MOD_SHARED3P_EMU_THREADPOOL_H
+#define MOD_SHARED3P_EMU_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sharemind {
+
+/**
+ * \brief Fixed size pool of worker threads for data parallel loops.
+ *
+ * The pool is shared by all process instances of a protection domain, hence
+ * parallelFor may be called concurrently from several threads. The calling
+ * thread always takes part in executing its own loop, so nested or concurrent
+ * calls make progress even when all workers are busy.
+ */
+class __attribute__ ((visibility("internal"))) ThreadPool {
+
+private: /* Types: */
+
+    struct Job {
+
+        Job(size_t numChunks_, std::function<void (size_t)> f_)
+            : f(std::move(f_))
+            , numChunks(numChunks_)
+        {}
+
+        std::function<void (size_t)> const f;
+        size_t const numChunks;
+        std::atomic<size_t> nextChunk{0u};
+        std::atomic<size_t> chunksDone{0u};
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::exception_ptr exception;
+
+    }; /* struct Job { */
+
+public: /* Methods: */
+
+    /**
+     * \param[in] numThreads total number of threads (including the caller of
+     *                       parallelFor) to use, 0 means one per hardware
+     *                       thread.
+     */
+    inline explicit ThreadPool(size_t numThreads) {
+        if (numThreads == 0u)
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+        m_workers.reserve(numThreads - 1u);
+        for (size_t i = 1u; i < numThreads; ++i)
+            m_workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    inline ~ThreadPool() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_cond.notify_all();
+        for (std::thread & worker : m_workers)
+            worker.join();
+    }
+
+    inline size_t numThreads() const noexcept
+    { return m_workers.size() + 1u; }
+
+    /**
+     * \brief Calls f(begin, end) for consecutive ranges of [0, size) of at
+     *        most grainSize elements and waits for all of them to finish.
+     * \note The ranges are always the same for the same size and grainSize.
+     * \throws the first exception thrown by f.
+     */
+    template <typename F>
+    void parallelFor(size_t size, size_t grainSize, F && f) {
+        if (size == 0u)
+            return;
+
+        grainSize = std::max(grainSize, size_t(1u));
+        const size_t numChunks = (size - 1u) / grainSize + 1u;
+        if (numChunks == 1u || m_workers.empty()) {
+            for (size_t begin = 0u; begin < size; begin += grainSize)
+                f(begin, std::min(begin + grainSize, size));
+            return;
+        }
+
+        const auto job = std::make_shared<Job>(numChunks,
+            [&f, size, grainSize](size_t chunk) {
+                const size_t begin = chunk * grainSize;
+                f(begin, std::min(begin + grainSize, size));
+            });
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back(job);
+        }
+        m_cond.notify_all();
+
+        runJob(job);
+
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->cond.wait(lock, [&job] {
+                return job->chunksDone.load() == job->numChunks;
+            });
+
+        if (job->exception)
+            std::rethrow_exception(job->exception);
+    }
+
+private: /* Methods: */
+
+    void workerLoop() noexcept {
+        for (;;) {
+            std::shared_ptr<Job> job;
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cond.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+                if (m_jobs.empty())
+                    return;
+
+                job = m_jobs.front();
+            }
+
+            runJob(job);
+        }
+    }
+
+    void runJob(const std::shared_ptr<Job> & job) noexcept {
+        for (;;) {
+            const size_t chunk = job->nextChunk.fetch_add(1u);
+            if (chunk >= job->numChunks)
+                break;
+
+            try {
+                job->f(chunk);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                if (!job->exception)
+                    job->exception = std::current_exception();
+            }
+
+            if (job->chunksDone.fetch_add(1u) + 1u == job->numChunks) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->cond.notify_all();
+            }
+        }
+
+        // All chunks have been claimed, stop offering the job to workers:
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = std::find(m_jobs.begin(), m_jobs.end(), job);
+        if (it != m_jobs.end())
+            m_jobs.erase(it);
+    }
+
+private: /* Fields: */
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::shared_ptr<Job> > m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stop = false;
+
+}; /* class ThreadPool { */
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_THREADPOOL_H */
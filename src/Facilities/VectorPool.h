@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef MOD_SHARED3P_EMU_VECTORPOOL_H
+#define MOD_SHARED3P_EMU_VECTORPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include "../Shared3pVector.h"
+
+namespace sharemind {
+
+/**
+ * \brief Per process pool of deleted share vectors, recycled by later
+ *        allocations of the same type.
+ *
+ * A released vector is removed from the shared value heap as usual, but its
+ * storage is first moved to a vector owned by the pool, so pooled vectors
+ * have no valid handles. Vectors are kept in size classes by the power of two
+ * of their capacity. An allocation takes a vector from the smallest class that
+ * is guaranteed to fit or from the class above it.
+ */
+class __attribute__ ((visibility("internal"))) VectorPool {
+
+public: /* Types: */
+
+    struct Statistics {
+        uint64_t allocations = 0u;
+        uint64_t hits = 0u;
+        uint64_t releases = 0u;
+        uint64_t discards = 0u;
+        size_t retainedBytes = 0u;
+        size_t peakRetainedBytes = 0u;
+    };
+
+private: /* Types: */
+
+    static constexpr size_t NUM_CLASSES = 8u * sizeof(size_t) + 1u;
+
+    struct Entry {
+        void * vec;
+        size_t capacity;
+        size_t bytes;
+    };
+
+    /* Free vectors of a single type, class c has capacities in [2^(c-1), 2^c). */
+    struct TypePool {
+        void (* destroy)(void *) = nullptr;
+        std::vector<Entry> classes[NUM_CLASSES];
+    };
+
+public: /* Methods: */
+
+    /**
+     * \param[in] maxRetainedBytes the upper limit on the storage of the pooled
+     *                             vectors, 0 disables pooling.
+     */
+    inline explicit VectorPool(size_t maxRetainedBytes) noexcept
+        : m_maxRetainedBytes(maxRetainedBytes)
+    {}
+
+    VectorPool(const VectorPool &) = delete;
+    VectorPool & operator=(const VectorPool &) = delete;
+
+    ~VectorPool() noexcept {
+        for (TypePool & pool : m_types)
+            for (std::vector<Entry> & entries : pool.classes)
+                for (const Entry & entry : entries)
+                    pool.destroy(entry.vec);
+    }
+
+    /**
+     * \returns an unregistered pooled vector resized to size elements with
+     *          value initialized elements or nullptr if there is none.
+     */
+    template <typename T>
+    ShareVec<T> * acquire(size_t size) {
+        ++ m_statistics.allocations;
+        if (size == 0u || m_statistics.retainedBytes == 0u)
+            return nullptr;
+
+        const size_t id = typeId<T>();
+        if (id >= m_types.size())
+            return nullptr;
+
+        TypePool & pool = m_types[id];
+        for (size_t c = sizeClass(size - 1u) + 1u;
+             c < NUM_CLASSES && c <= sizeClass(size - 1u) + 2u;
+             ++ c)
+        {
+            if (pool.classes[c].empty())
+                continue;
+
+            const Entry entry = pool.classes[c].back();
+            pool.classes[c].pop_back();
+            m_statistics.retainedBytes -= entry.bytes;
+            ++ m_statistics.hits;
+
+            std::unique_ptr<ShareVec<T> > vec(
+                    static_cast<ShareVec<T> *>(entry.vec));
+            vec->resize(0u);
+            vec->resize(size);
+            return vec.release();
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * \brief Moves the storage of the vector into the pool, if it fits.
+     *
+     * The vector itself stays with the caller and has to be freed as usual.
+     * \returns whether the storage was pooled.
+     */
+    template <typename T>
+    bool release(ShareVec<T> & vec) noexcept {
+        // The capacity is at least the current size:
+        const size_t capacity = vec.size();
+        const size_t bytes = storageBytes(vec);
+        if (capacity == 0u
+            || bytes > m_maxRetainedBytes / 4u
+            || m_statistics.retainedBytes + bytes > m_maxRetainedBytes)
+        {
+            ++ m_statistics.discards;
+            return false;
+        }
+
+        try {
+            const size_t id = typeId<T>();
+            if (id >= m_types.size())
+                m_types.resize(id + 1u);
+
+            TypePool & pool = m_types[id];
+            pool.destroy = &destroy<T>;
+            std::vector<Entry> & entries = pool.classes[sizeClass(capacity)];
+            entries.reserve(entries.size() + 1u);
+            entries.push_back(Entry{new ShareVec<T>(std::move(vec)),
+                                    capacity,
+                                    bytes});
+        } catch (...) {
+            ++ m_statistics.discards;
+            return false;
+        }
+
+        ++ m_statistics.releases;
+        m_statistics.retainedBytes += bytes;
+        if (m_statistics.retainedBytes > m_statistics.peakRetainedBytes)
+            m_statistics.peakRetainedBytes = m_statistics.retainedBytes;
+
+        return true;
+    }
+
+    inline const Statistics & statistics() const noexcept
+    { return m_statistics; }
+
+private: /* Methods: */
+
+    template <typename T>
+    static inline size_t storageBytes(const ShareVec<T> & vec) noexcept
+    { return vec.size() * sizeof(typename ValueTraits<T>::share_type); }
+
+    /* Bit vectors store their elements packed into blocks: */
+    static inline size_t storageBytes(const ShareVec<s3p_bool_t> & vec) noexcept {
+        return vec.numBlocks()
+               * sizeof(ShareVec<s3p_bool_t>::block_type);
+    }
+
+    template <typename T>
+    static void destroy(void * vec) noexcept
+    { delete static_cast<ShareVec<T> *>(vec); }
+
+    /* The number of significant bits of n: */
+    static inline size_t sizeClass(size_t n) noexcept {
+        return n == 0u
+               ? 0u
+               : 8u * sizeof(unsigned long long)
+                 - static_cast<size_t>(__builtin_clzll(n));
+    }
+
+    static inline size_t nextTypeId() noexcept {
+        static std::atomic<size_t> next(0u);
+        return next++;
+    }
+
+    template <typename T>
+    static inline size_t typeId() noexcept {
+        static const size_t id = nextTypeId();
+        return id;
+    }
+
+private: /* Fields: */
+
+    const size_t m_maxRetainedBytes;
+    std::vector<TypePool> m_types;
+    Statistics m_statistics;
+
+}; /* class VectorPool { */
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_VECTORPOOL_H */
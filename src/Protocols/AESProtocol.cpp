@@ -19,6 +19,15 @@
 
 #include "AESProtocol.h"
 
+#include <map>
+#include <memory>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <wmmintrin.h>
+#define MOD_SHARED3P_EMU_AESNI
+#endif
+
 
 namespace sharemind {
 namespace {
@@ -73,6 +82,220 @@ static constexpr uint8_t rcon[255] = {
   0x61, 0xc2, 0x9f, 0x25, 0x4a, 0x94, 0x33, 0x66, 0xcc, 0x83, 0x1d, 0x3a, 0x74, 0xe8, 0xcb
 };
 
+constexpr size_t BLOCK_SIZE = 16u;
+
+/** Number of blocks that are encrypted in an interleaved manner. */
+constexpr size_t PIPELINE_BLOCKS = 8u;
+
+inline uint32_t subWord(const uint32_t w) noexcept {
+    return static_cast<uint32_t>(sbox[w & 0xffu]) |
+           static_cast<uint32_t>(sbox[(w >> 8u) & 0xffu]) << 8u |
+           static_cast<uint32_t>(sbox[(w >> 16u) & 0xffu]) << 16u |
+           static_cast<uint32_t>(sbox[(w >> 24u) & 0xffu]) << 24u;
+}
+
+/**
+  Computes the Nb * (Nr + 1) words of the FIPS-197 key schedule of the given
+  Nk word key. Based on: https://github.com/kokke/tiny-AES128-C
+*/
+template <size_t Nk, size_t Nb, size_t Nr>
+void expandKeyWords(const uint32_t * key, uint32_t * w) noexcept {
+    std::copy(key, key + Nk, w);
+    for (size_t i = Nk; i < Nb * (Nr + 1u); ++i) {
+        uint32_t tmp = w[i - 1u];
+        if (i % Nk == 0u) {
+            // SubWord(RotWord(tmp)) ^ Rcon:
+            tmp = subWord((tmp << 8u) | (tmp >> 24u))
+                  ^ static_cast<uint32_t>(rcon[i / Nk]) << 24u;
+        } else if (Nk > 6u && i % Nk == 4u) {
+            tmp = subWord(tmp);
+        }
+        w[i] = w[i - Nk] ^ tmp;
+    }
+}
+
+inline bool haveAesNi() noexcept {
+#ifdef MOD_SHARED3P_EMU_AESNI
+    static const bool supported = __builtin_cpu_supports("aes");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+  The distinct keys of a single call together with their schedules. With
+  AES-NI the schedules are the round keys in FIPS-197 byte order, otherwise
+  they are Crypto++ cipher objects.
+*/
+template <size_t Nk, size_t Nb, size_t Nr>
+class KeySchedules {
+
+public: /* Types: */
+
+    using Key = std::array<uint32_t, Nk>;
+
+    static constexpr size_t ROUND_KEYS_SIZE = Nb * sizeof(uint32_t) * (Nr + 1u);
+
+public: /* Methods: */
+
+    explicit KeySchedules(const bool aesNi)
+        : m_aesNi(aesNi)
+    {}
+
+    /** \returns the identifier of the schedule of the given key. */
+    size_t add(const Key & key) {
+        // Consecutive blocks are usually encrypted with the same key:
+        if (!m_ids.empty() && key == m_lastKey)
+            return m_lastId;
+
+        const auto r = m_ids.emplace(key, m_ids.size());
+        if (r.second)
+            build(key);
+
+        m_lastKey = key;
+        m_lastId = r.first->second;
+        return m_lastId;
+    }
+
+    size_t size() const noexcept { return m_ids.size(); }
+
+    const uint8_t * roundKeys() const noexcept { return m_roundKeys.data(); }
+
+    const CryptoPP::AESEncryption & cipher(const size_t id) const noexcept
+    { return *m_ciphers[id]; }
+
+private: /* Methods: */
+
+    void build(const Key & key) {
+        if (m_aesNi) {
+            std::array<uint32_t, Nb * (Nr + 1u)> w;
+            expandKeyWords<Nk, Nb, Nr>(key.data(), w.data());
+            const size_t offset = m_roundKeys.size();
+            m_roundKeys.resize(offset + ROUND_KEYS_SIZE);
+            for (size_t i = 0u; i < w.size(); ++i) {
+                m_roundKeys[offset + 4u * i] = static_cast<uint8_t>(w[i] >> 24u);
+                m_roundKeys[offset + 4u * i + 1u] = static_cast<uint8_t>(w[i] >> 16u);
+                m_roundKeys[offset + 4u * i + 2u] = static_cast<uint8_t>(w[i] >> 8u);
+                m_roundKeys[offset + 4u * i + 3u] = static_cast<uint8_t>(w[i]);
+            }
+        } else {
+            Key bytes;
+            std::transform(key.cbegin(), key.cend(), bytes.begin(), EndianessSwap);
+            m_ciphers.emplace_back(
+                        new CryptoPP::AESEncryption(
+                            reinterpret_cast<const uint8_t *>(bytes.data()),
+                            Nk * sizeof(uint32_t)));
+        }
+    }
+
+private: /* Fields: */
+
+    const bool m_aesNi;
+    std::map<Key, size_t> m_ids;
+    Key m_lastKey;
+    size_t m_lastId = 0u;
+    std::vector<uint8_t> m_roundKeys;
+    std::vector<std::unique_ptr<CryptoPP::AESEncryption> > m_ciphers;
+
+}; /* class KeySchedules { */
+
+#ifdef MOD_SHARED3P_EMU_AESNI
+
+__attribute__ ((target("sse2")))
+inline __m128i loadBlock(const uint8_t * p) noexcept
+{ return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+
+__attribute__ ((target("sse2")))
+inline void storeBlock(uint8_t * p, const __m128i v) noexcept
+{ _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+
+/**
+  Encrypts the blocks in place, block i with the round keys starting at
+  roundKeys + keyOffset(i). PIPELINE_BLOCKS blocks are in flight at a time to
+  hide the latency of the AES instructions.
+*/
+template <size_t Nr, typename KeyOffset>
+__attribute__ ((target("aes,sse2")))
+void encryptAesNi(const uint8_t * roundKeys,
+                  KeyOffset keyOffset,
+                  uint8_t * data,
+                  size_t nblocks) noexcept
+{
+    size_t b = 0u;
+    for (; b + PIPELINE_BLOCKS <= nblocks; b += PIPELINE_BLOCKS) {
+        const uint8_t * rk[PIPELINE_BLOCKS];
+        __m128i s[PIPELINE_BLOCKS];
+        for (size_t j = 0u; j < PIPELINE_BLOCKS; ++j) {
+            rk[j] = roundKeys + keyOffset(b + j);
+            s[j] = _mm_xor_si128(loadBlock(data + (b + j) * BLOCK_SIZE), loadBlock(rk[j]));
+        }
+        for (size_t r = 1u; r < Nr; ++r)
+            for (size_t j = 0u; j < PIPELINE_BLOCKS; ++j)
+                s[j] = _mm_aesenc_si128(s[j], loadBlock(rk[j] + r * BLOCK_SIZE));
+        for (size_t j = 0u; j < PIPELINE_BLOCKS; ++j)
+            storeBlock(data + (b + j) * BLOCK_SIZE,
+                       _mm_aesenclast_si128(s[j], loadBlock(rk[j] + Nr * BLOCK_SIZE)));
+    }
+
+    for (; b < nblocks; ++b) {
+        const uint8_t * const rk = roundKeys + keyOffset(b);
+        __m128i s = _mm_xor_si128(loadBlock(data + b * BLOCK_SIZE), loadBlock(rk));
+        for (size_t r = 1u; r < Nr; ++r)
+            s = _mm_aesenc_si128(s, loadBlock(rk + r * BLOCK_SIZE));
+        storeBlock(data + b * BLOCK_SIZE,
+                   _mm_aesenclast_si128(s, loadBlock(rk + Nr * BLOCK_SIZE)));
+    }
+}
+
+#endif /* MOD_SHARED3P_EMU_AESNI */
+
+/**
+  Encrypts nblocks blocks of big-endian words in place. Block i uses the
+  schedule keyIds[i] or the only schedule if keyIds is empty.
+*/
+template <size_t Nk, size_t Nb, size_t Nr>
+void encryptBlocks(const KeySchedules<Nk, Nb, Nr> & schedules,
+                   const std::vector<size_t> & keyIds,
+                   AES_share_t * words,
+                   size_t nblocks)
+{
+    using Schedules = KeySchedules<Nk, Nb, Nr>;
+    uint8_t * const data = reinterpret_cast<uint8_t *>(words);
+
+#ifdef MOD_SHARED3P_EMU_AESNI
+    if (haveAesNi()) {
+        if (keyIds.empty()) {
+            encryptAesNi<Nr>(schedules.roundKeys(),
+                             [](size_t) noexcept { return size_t(0u); },
+                             data, nblocks);
+        } else {
+            const size_t * const ids = keyIds.data();
+            encryptAesNi<Nr>(schedules.roundKeys(),
+                             [ids](size_t i) noexcept
+                             { return ids[i] * Schedules::ROUND_KEYS_SIZE; },
+                             data, nblocks);
+        }
+        return;
+    }
+#endif
+
+    // Process runs of blocks with the same key, Crypto++ pipelines the blocks
+    // of a run itself:
+    for (size_t b = 0u; b < nblocks;) {
+        const size_t id = keyIds.empty() ? 0u : keyIds[b];
+        size_t e = keyIds.empty() ? nblocks : b + 1u;
+        while (e < nblocks && keyIds[e] == id)
+            ++e;
+        schedules.cipher(id).AdvancedProcessBlocks(data + b * BLOCK_SIZE,
+                                                   nullptr,
+                                                   data + b * BLOCK_SIZE,
+                                                   (e - b) * BLOCK_SIZE,
+                                                   0u);
+        b = e;
+    }
+}
+
 } /* namespace { */
 
 template<size_t Nk_, size_t Nb_, size_t Nr_>
@@ -86,53 +309,18 @@ void AesProtocol<Nk_, Nb_, Nr_>::expandAesKey(const AES_share_vec_t & inKey,
 
     const size_t nkeys = inKey.size() / Nk_;
 
-    // Based on: https://github.com/kokke/tiny-AES128-C
-
     auto outIndex = [](size_t nkeys_, size_t n, size_t i) noexcept {
         return n * Nb_ + (i / Nb_) * Nb_ * nkeys_ + i % Nb_;
     };
 
+    std::array<uint32_t, Nk_> key;
+    std::array<uint32_t, Nb_ * (Nr_ + 1u)> w;
     for (size_t n = 0u; n < nkeys; ++n) {
-        // The first round key is the key itself.
-        for (size_t i = 0u; i < Nk_; ++i) {
-            outKey[outIndex(nkeys, n, i)] = inKey[n * Nk_ + i];
-        }
-
-        // All other round keys are found from the previous round keys.
-        for (size_t i = Nk_; i < (Nb_ * (Nr_ + 1u)); ++i) {
-            uint32_t tmp = outKey[outIndex(nkeys, n, i - 1u)];
-            if (i % Nk_ == 0u) {
-                // This function rotates the 4 bytes in a word to the left once.
-                // [a0,a1,a2,a3] becomes [a1,a2,a3,a0]
-
-                // Function RotWord()
-                {
-                    tmp = ((tmp << 8u) & 0xffffff00) | ((tmp >> 24u) & 0xff);
-                }
-
-                // SubWord() is a function that takes a four-byte input word and
-                // applies the S-box to each of the four bytes to produce an output word.
-
-                // Function Subword()
-                {
-                    tmp = static_cast<uint32_t>(sbox[static_cast<uint8_t>(tmp & 0xff)]) |
-                            static_cast<uint32_t>(sbox[static_cast<uint8_t>((tmp >> 8u) & 0xff)]) << 8u |
-                            static_cast<uint32_t>(sbox[static_cast<uint8_t>((tmp >> 16u) & 0xff)]) << 16u |
-                            static_cast<uint32_t>(sbox[static_cast<uint8_t>((tmp >> 24u) & 0xff)]) << 24u;
-                }
-
-                tmp ^= 0xff000000 & static_cast<uint32_t>(rcon[i / Nk_]) << 24u;
-            } else if (Nk_ > 6u && i % Nk_ == 4u) {
-                // Function Subword()
-                {
-                    tmp = static_cast<uint32_t>(sbox[static_cast<uint8_t>(tmp & 0xff)]) |
-                            static_cast<uint32_t>(sbox[static_cast<uint8_t>((tmp >> 8u) & 0xff)]) << 8u |
-                            static_cast<uint32_t>(sbox[static_cast<uint8_t>((tmp >> 16u) & 0xff)]) << 16u |
-                            static_cast<uint32_t>(sbox[static_cast<uint8_t>((tmp >> 24u) & 0xff)]) << 24u;
-                }
-            }
-            outKey[outIndex(nkeys, n, i)] = outKey[outIndex(nkeys, n, i - Nk_)] ^ tmp;
-        }
+        std::copy(inKey.cbegin() + n * Nk_, inKey.cbegin() + (n + 1u) * Nk_,
+                  key.begin());
+        expandKeyWords<Nk_, Nb_, Nr_>(key.data(), w.data());
+        for (size_t i = 0u; i < w.size(); ++i)
+            outKey[outIndex(nkeys, n, i)] = w[i];
     }
 }
 
@@ -147,32 +335,28 @@ void AesProtocol<Nk_, Nb_, Nr_>::processWithExpandedKey(const AES_share_vec_t &
     assert(plainText.size() / Nb_ == preExpandedKey.size() / (Nb_ * (Nr_ + 1u)));
 
     const size_t nblocks = plainText.size() / Nb_;
-    auto pit = plainText.cbegin();
-    auto cit = cipherText.begin();
 
     auto keyIndex = [](size_t nblocks_, size_t n, size_t i) noexcept {
         return n * Nb_ + (i / Nb_) * Nb_ * nblocks_ + i % Nb_;
     };
 
+    // Only the first Nk words of every expanded key are used. Blocks with
+    // equal keys share the schedule:
+    KeySchedules<Nk_, Nb_, Nr_> schedules(haveAesNi());
+    std::vector<size_t> keyIds(nblocks);
+    typename KeySchedules<Nk_, Nb_, Nr_>::Key key;
     for (size_t n = 0u; n < nblocks; ++n) {
-        std::array<AES_share_vec_t::value_type, Nk_> key;
-        for (size_t i = 0u; i < Nk_; ++i) {
+        for (size_t i = 0u; i < Nk_; ++i)
             key[i] = preExpandedKey[keyIndex(nblocks, n, i)];
-        }
-        std::transform(key.cbegin(), key.cend(), key.begin(), EndianessSwap);
-
-        std::array<AES_share_vec_t::value_type, Nb_> pt;
-        std::array<AES_share_vec_t::value_type, Nb_> ct;
-        CryptoPP::AESEncryption enc(reinterpret_cast<uint8_t*>(key.data()),
-                                    Nk_ * sizeof(AES_share_vec_t::value_type));
-        std::transform(pit, pit + Nb_, pt.begin(), EndianessSwap);
-        enc.ProcessBlock(reinterpret_cast<uint8_t*>(pt.data()),
-                         reinterpret_cast<uint8_t*>(ct.data()));
-        std::transform(ct.cbegin(), ct.cend(), cit, EndianessSwap);
-
-        pit += Nb_;
-        cit += Nb_;
+        keyIds[n] = schedules.add(key);
     }
+    if (schedules.size() == 1u)
+        keyIds.clear();
+
+    std::vector<AES_share_t> data(plainText.size());
+    std::transform(plainText.cbegin(), plainText.cend(), data.begin(), EndianessSwap);
+    encryptBlocks(schedules, keyIds, data.data(), nblocks);
+    std::transform(data.cbegin(), data.cend(), cipherText.begin(), EndianessSwap);
 }
 
 template<size_t Nk_, size_t Nb_, size_t Nr_>
@@ -184,28 +368,16 @@ void AesProtocol<Nk_, Nb_, Nr_>::processWithSingleExpandedKey(const AES_share_ve
     assert(plainText.size() % Nb_ == 0u);
     assert(preExpandedKey.size() == (Nb_ * (Nr_ + 1u)));
 
-    std::array<AES_share_vec_t::value_type, Nk_> key;
-    std::transform(preExpandedKey.cbegin(), preExpandedKey.cbegin() + Nk_,
-            key.begin(), EndianessSwap);
-
-    std::array<AES_share_vec_t::value_type, Nb_> pt;
-    std::array<AES_share_vec_t::value_type, Nb_> ct;
-    CryptoPP::AESEncryption enc(reinterpret_cast<uint8_t*>(key.data()),
-                                Nk_ * sizeof(AES_share_vec_t::value_type));
-
-    auto pit = plainText.cbegin();
-    auto cit = cipherText.begin();
-    do {
-        std::transform(pit, pit + Nb_, pt.begin(), EndianessSwap);
-        enc.ProcessBlock(reinterpret_cast<uint8_t*>(pt.data()),
-                         reinterpret_cast<uint8_t*>(ct.data()));
-        std::transform(ct.cbegin(), ct.cend(), cit, EndianessSwap);
-
-        pit += Nb_;
-        cit += Nb_;
-    } while (pit != plainText.end() && cit != cipherText.end());
-}
+    KeySchedules<Nk_, Nb_, Nr_> schedules(haveAesNi());
+    typename KeySchedules<Nk_, Nb_, Nr_>::Key key;
+    std::copy(preExpandedKey.cbegin(), preExpandedKey.cbegin() + Nk_, key.begin());
+    schedules.add(key);
 
+    std::vector<AES_share_t> data(plainText.size());
+    std::transform(plainText.cbegin(), plainText.cend(), data.begin(), EndianessSwap);
+    encryptBlocks(schedules, std::vector<size_t>(), data.data(), plainText.size() / Nb_);
+    std::transform(data.cbegin(), data.cend(), cipherText.begin(), EndianessSwap);
+}
 
 template class AesProtocol<4u, 4u, 10u>;
 template class AesProtocol<6u, 4u, 12u>;
@@ -26,6 +26,9 @@
 #include "../Shared3pPDPI.h"
 #include "../Shared3pValueTraits.h"
 #include "../Shared3pVector.h"
+#include "ConstantDivision.h"
+#include "NativeFloat.h"
+#include "PackedComparison.h"
 #include "SoftFloatUtility.h"
 
 namespace sharemind {
@@ -34,7 +37,7 @@ template<>
 class __attribute__ ((visibility("internal"))) AdditionProtocol<Shared3pPDPI> {
 public: /* Methods: */
 
-    AdditionProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+    AdditionProtocol(Shared3pPDPI & pdpi) : m_nativeFloat(pdpi) {}
 
     template <typename T>
     typename std::enable_if<is_integral_value_tag<T>::value, bool>::type
@@ -60,12 +63,21 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
+        if (m_nativeFloat.enabled()) {
+            m_nativeFloat.apply<NativeFloatAdd>(param1, param2, result);
+            return true;
+        }
+
         for (size_t i = 0u; i < param1.size(); ++i)
             result[i] = sf_float_add(param1[i], param2[i]).result;
 
         return true;
     }
 
+private: /* Fields: */
+
+    NativeFloat m_nativeFloat;
+
 }; /* class AdditionProtocol { */
 
 template<>
@@ -101,8 +113,9 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
-        for (size_t i = 0u; i < param1.size(); ++i)
-            result[i] = param1[i] && param2[i];
+        using B = ShareVec<s3p_bool_t>::block_type;
+        result.transformBlocks(param1, param2,
+                               [](B a, B b) noexcept { return a & b; });
 
         return true;
     }
@@ -142,19 +155,62 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
-        for (size_t i = 0u; i < param1.size(); ++i)
-            result[i] = param1[i] || param2[i];
+        using B = ShareVec<s3p_bool_t>::block_type;
+        result.transformBlocks(param1, param2,
+                               [](B a, B b) noexcept { return a | b; });
 
         return true;
     }
 
 }; /* class BitwiseOrProtocol { */
 
+template<>
+class __attribute__ ((visibility("internal"))) BitwiseXorProtocol<Shared3pPDPI> {
+public: /* Methods: */
+
+    BitwiseXorProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+
+    template <typename T>
+    typename std::enable_if<
+        is_any_value_tag<T>::value &&
+        ! is_bool_value_tag<T>::value
+    , bool>::type
+    invoke(const ShareVec<T> & param1,
+           const ShareVec<T> & param2,
+           ShareVec<T> & result)
+    {
+        if (param1.size() != param2.size() || param1.size() != result.size())
+            return false;
+
+        for (size_t i = 0u; i < param1.size(); ++i)
+            result[i] = param1[i] ^ param2[i];
+
+        return true;
+    }
+
+    template <typename T>
+    typename std::enable_if<is_bool_value_tag<T>::value, bool>::type
+    invoke(const ShareVec<T> & param1,
+           const ShareVec<T> & param2,
+           ShareVec<T> & result)
+    {
+        if (param1.size() != param2.size() || param1.size() != result.size())
+            return false;
+
+        using B = ShareVec<s3p_bool_t>::block_type;
+        result.transformBlocks(param1, param2,
+                               [](B a, B b) noexcept { return a ^ b; });
+
+        return true;
+    }
+
+}; /* class BitwiseXorProtocol { */
+
 template<>
 class __attribute__ ((visibility("internal"))) DivisionProtocol<Shared3pPDPI> {
 public: /* Methods: */
 
-    DivisionProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+    DivisionProtocol(Shared3pPDPI & pdpi) : m_nativeFloat(pdpi) {}
 
     template <typename T>
     typename std::enable_if<is_integral_value_tag<T>::value, bool>::type
@@ -182,6 +238,11 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
+        if (m_nativeFloat.enabled()) {
+            m_nativeFloat.apply<NativeFloatDiv>(param1, param2, result);
+            return true;
+        }
+
         for (size_t i = 0u; i < param1.size(); ++i) {
             if (param2[i] != 0)
                 result[i] = sf_float_div(param1[i], param2[i]).result;
@@ -199,15 +260,7 @@ public: /* Methods: */
         if (param1.size() > param2.size() || param1.size() != result.size())
             return false;
 
-        for (size_t i = 0u; i < param1.size(); ++i) {
-            if (param2[i] == 0)
-                return false;
-        }
-
-        for (size_t i = 0u; i < param1.size(); ++i)
-            result[i] = param1[i] / param2[i];
-
-        return true;
+        return divideByPublic<PublicQuotient>(param1, param2, result);
     }
 
     template <typename T>
@@ -224,12 +277,21 @@ public: /* Methods: */
                 return false;
         }
 
+        if (m_nativeFloat.enabled()) {
+            m_nativeFloat.apply<NativeFloatDiv>(param1, param2, result);
+            return true;
+        }
+
         for (size_t i = 0u; i < param1.size(); ++i)
             result[i] = sf_float_div(param1[i], param2[i]).result;
 
         return true;
     }
 
+private: /* Fields: */
+
+    NativeFloat m_nativeFloat;
+
 }; /* class DivisionProtocol { */
 
 template<>
@@ -241,7 +303,8 @@ public: /* Methods: */
     template <typename T>
     typename std::enable_if<
         is_any_value_tag<T>::value &&
-        ! is_float_value_tag<T>::value
+        ! is_float_value_tag<T>::value &&
+        ! is_bool_value_tag<T>::value
     , bool>::type
     invoke(const ShareVec<T> & param1,
            const ShareVec<T> & param2,
@@ -250,8 +313,7 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
-        for (size_t i = 0u; i < param1.size(); ++i)
-            result[i] = param1[i] == param2[i];
+        comparePacked(param1, param2, result, PackedEqual());
 
         return true;
     }
@@ -271,6 +333,22 @@ public: /* Methods: */
         return true;
     }
 
+    template <typename T>
+    typename std::enable_if<is_bool_value_tag<T>::value, bool>::type
+    invoke(const ShareVec<T> & param1,
+           const ShareVec<T> & param2,
+           ShareVec<s3p_bool_t> & result)
+    {
+        if (param1.size() != param2.size() || param1.size() != result.size())
+            return false;
+
+        using B = ShareVec<s3p_bool_t>::block_type;
+        result.transformBlocks(param1, param2,
+                               [](B a, B b) noexcept { return B(~(a ^ b)); });
+
+        return true;
+    }
+
 }; /* class EqualityProtocol { */
 
 template<>
@@ -291,8 +369,7 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
-        for (size_t i = 0u; i < param1.size(); ++i)
-            result[i] = param1[i] > param2[i];
+        comparePacked(param1, param2, result, PackedGreater());
 
         return true;
     }
@@ -332,8 +409,7 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
-        for (size_t i = 0u; i < param1.size(); ++i)
-            result[i] = param1[i] >= param2[i];
+        comparePacked(param1, param2, result, PackedGreaterOrEqual());
 
         return true;
     }
@@ -534,8 +610,7 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
-        for (size_t i = 0u; i < param1.size(); ++i)
-            result[i] = param1[i] < param2[i];
+        comparePacked(param1, param2, result, PackedLess());
 
         return true;
     }
@@ -575,8 +650,7 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
-        for (size_t i = 0u; i < param1.size(); ++i)
-            result[i] = param1[i] <= param2[i];
+        comparePacked(param1, param2, result, PackedLessOrEqual());
 
         return true;
     }
@@ -684,7 +758,7 @@ template<>
 class __attribute__ ((visibility("internal"))) MultiplicationProtocol<Shared3pPDPI> {
 public: /* Methods: */
 
-    MultiplicationProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+    MultiplicationProtocol(Shared3pPDPI & pdpi) : m_nativeFloat(pdpi) {}
 
     template <typename T>
     typename std::enable_if<is_integral_value_tag<T>::value, bool>::type
@@ -710,6 +784,11 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
+        if (m_nativeFloat.enabled()) {
+            m_nativeFloat.apply<NativeFloatMul>(param1, param2, result);
+            return true;
+        }
+
         for (size_t i = 0u; i < param1.size(); ++i)
             result[i] = sf_float_mul(param1[i], param2[i]).result;
 
@@ -740,14 +819,73 @@ public: /* Methods: */
         if (param1.size() > param2.size() || param1.size() != result.size())
             return false;
 
+        if (m_nativeFloat.enabled()) {
+            m_nativeFloat.apply<NativeFloatMul>(param1, param2, result);
+            return true;
+        }
+
         for (size_t i = 0u; i < param1.size(); ++i)
             result[i] = sf_float_mul(param1[i], param2[i]).result;
 
         return true;
     }
 
+private: /* Fields: */
+
+    NativeFloat m_nativeFloat;
+
 }; /* class MultiplicationProtocol { */
 
+/**
+ * \brief Computes the sum of param1[i] * param2[i] into result[0].
+ *
+ * Floating point products are added from left to right, rounding after every
+ * operation.
+ */
+class __attribute__ ((visibility("internal"))) MultiplySumProtocol {
+public: /* Methods: */
+
+    MultiplySumProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+
+    template <typename T>
+    typename std::enable_if<is_integral_value_tag<T>::value, bool>::type
+    invoke(const ShareVec<T> & param1,
+           const ShareVec<T> & param2,
+           ShareVec<T> & result)
+    {
+        if (param1.size() != param2.size() || result.size() != 1u)
+            return false;
+
+        using S = typename ValueTraits<T>::share_type;
+        using W = wrapping_type<S>;
+
+        W sum = 0u;
+        for (size_t i = 0u; i < param1.size(); ++i)
+            sum += W(S(param1[i])) * W(S(param2[i]));
+
+        result[0u] = S(sum);
+        return true;
+    }
+
+    template <typename T>
+    typename std::enable_if<is_float_value_tag<T>::value, bool>::type
+    invoke(const ShareVec<T> & param1,
+           const ShareVec<T> & param2,
+           ShareVec<T> & result)
+    {
+        if (param1.size() != param2.size() || result.size() != 1u)
+            return false;
+
+        typename ValueTraits<T>::share_type sum = 0u;
+        for (size_t i = 0u; i < param1.size(); ++i)
+            sum = sf_float_add(sum, sf_float_mul(param1[i], param2[i]).result).result;
+
+        result[0u] = sum;
+        return true;
+    }
+
+}; /* class MultiplySumProtocol { */
+
 template<>
 class __attribute__ ((visibility("internal"))) RemainderProtocol<Shared3pPDPI> {
 public: /* Methods: */
@@ -780,15 +918,7 @@ public: /* Methods: */
         if (param1.size() > param2.size() || param1.size() != result.size())
             return false;
 
-        for (size_t i = 0u; i < param1.size(); ++i) {
-            if (param2[i] == 0)
-                return false;
-        }
-
-        for (size_t i = 0u; i < param1.size(); ++i)
-            result[i] = param1[i] % param2[i];
-
-        return true;
+        return divideByPublic<PublicRemainder>(param1, param2, result);
     }
 
 }; /* class RemainderProtocol { */
@@ -797,7 +927,7 @@ template<>
 class __attribute__ ((visibility("internal"))) SubtractionProtocol<Shared3pPDPI> {
 public: /* Methods: */
 
-    SubtractionProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+    SubtractionProtocol(Shared3pPDPI & pdpi) : m_nativeFloat(pdpi) {}
 
     template <typename T>
     typename std::enable_if<is_integral_value_tag<T>::value, bool>::type
@@ -823,14 +953,73 @@ public: /* Methods: */
         if (param1.size() != param2.size() || param1.size() != result.size())
             return false;
 
+        if (m_nativeFloat.enabled()) {
+            m_nativeFloat.apply<NativeFloatSub>(param1, param2, result);
+            return true;
+        }
+
         for (size_t i = 0u; i < param1.size(); ++i)
             result[i] = sf_float_sub(param1[i], param2[i]).result;
 
         return true;
     }
 
+private: /* Fields: */
+
+    NativeFloat m_nativeFloat;
+
 }; /* class SubtractionProtocol { */
 
+/**
+ * \brief Computes (param1 - param2)^2 in a single pass.
+ *
+ * Floating point results are rounded after the subtraction and after the
+ * multiplication so that they equal those of separate sub and mul calls.
+ */
+class __attribute__ ((visibility("internal"))) SubtractSquareProtocol {
+public: /* Methods: */
+
+    SubtractSquareProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+
+    template <typename T>
+    typename std::enable_if<is_integral_value_tag<T>::value, bool>::type
+    invoke(const ShareVec<T> & param1,
+           const ShareVec<T> & param2,
+           ShareVec<T> & result)
+    {
+        if (param1.size() != param2.size() || param1.size() != result.size())
+            return false;
+
+        using S = typename ValueTraits<T>::share_type;
+        using W = wrapping_type<S>;
+
+        for (size_t i = 0u; i < param1.size(); ++i) {
+            const W d = W(S(param1[i])) - W(S(param2[i]));
+            result[i] = S(d * d);
+        }
+
+        return true;
+    }
+
+    template <typename T>
+    typename std::enable_if<is_float_value_tag<T>::value, bool>::type
+    invoke(const ShareVec<T> & param1,
+           const ShareVec<T> & param2,
+           ShareVec<T> & result)
+    {
+        if (param1.size() != param2.size() || param1.size() != result.size())
+            return false;
+
+        for (size_t i = 0u; i < param1.size(); ++i) {
+            const auto d = sf_float_sub(param1[i], param2[i]).result;
+            result[i] = sf_float_mul(d, d).result;
+        }
+
+        return true;
+    }
+
+}; /* class SubtractSquareProtocol { */
+
 } /* namespace sharemind { */
 
 #endif /* MOD_SHARED3P_EMU_PROTOCOLS_BINARY_H */
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef MOD_SHARED3P_EMU_PROTOCOLS_BITMATRIXMULTIPLICATION_H
+#define MOD_SHARED3P_EMU_PROTOCOLS_BITMATRIXMULTIPLICATION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "../Facilities/ThreadPool.h"
+
+
+namespace sharemind {
+
+/**
+ * \brief Matrix product with xor as addition and bitwise and as
+ *        multiplication.
+ *
+ * Every bit position of the words is an independent matrix product over
+ * GF(2). The bit planes are multiplied as packed bit matrices with the Method
+ * of Four Russians: the xor of every subset of eight consecutive rows of B is
+ * tabulated, after which eight bits of a row of A select a single table row
+ * to add to the result row. TABLES such tables are used at a time to reduce
+ * the passes over the result. The words are split into bit planes (and joined
+ * back) by 64 x 64 bit matrix transpositions and the planes are multiplied in
+ * parallel.
+ */
+template <typename U>
+class __attribute__ ((visibility("internal"))) BitMatrixMultiplication {
+
+    static_assert(std::is_unsigned<U>::value, "");
+
+private: /* Types: */
+
+    using Word = uint64_t;
+
+    static constexpr size_t WORD_BITS = 64u;
+    static constexpr size_t PLANES = 8u * sizeof(U);
+    static constexpr size_t TABLES = 4u;
+    static constexpr size_t TABLE_ROWS = 256u;
+
+public: /* Methods: */
+
+    /**
+     * \brief Computes c = a * b for row-major a (m x k), b (k x n) and
+     *        c (m x n).
+     */
+    static void multiply(const U * a,
+                         const U * b,
+                         U * c,
+                         size_t m,
+                         size_t k,
+                         size_t n,
+                         ThreadPool & pool)
+    {
+        const size_t kw = (k + WORD_BITS - 1u) / WORD_BITS;
+        const size_t nw = (n + WORD_BITS - 1u) / WORD_BITS;
+        std::vector<Word> aPlanes(PLANES * m * kw);
+        std::vector<Word> bPlanes(PLANES * k * nw);
+        std::vector<Word> cPlanes(PLANES * m * nw, 0u);
+
+        pool.parallelFor(m, 64u, [&](size_t begin, size_t end) {
+            toPlanes(a, begin, end, k, kw, m * kw, aPlanes.data());
+        });
+        pool.parallelFor(k, 64u, [&](size_t begin, size_t end) {
+            toPlanes(b, begin, end, n, nw, k * nw, bPlanes.data());
+        });
+
+        pool.parallelFor(PLANES, 1u, [&](size_t begin, size_t end) {
+            std::vector<Word> tables(TABLES * TABLE_ROWS * nw);
+            for (size_t bit = begin; bit < end; ++ bit)
+                multiplyPlane(&aPlanes[bit * m * kw],
+                              &bPlanes[bit * k * nw],
+                              &cPlanes[bit * m * nw],
+                              tables.data(),
+                              m, k, kw, nw);
+        });
+
+        pool.parallelFor(m, 64u, [&](size_t begin, size_t end) {
+            fromPlanes(cPlanes.data(), begin, end, n, nw, m * nw, c);
+        });
+    }
+
+private: /* Methods: */
+
+    /* Transposes the 64 x 64 bit matrix with rows a[0..64). */
+    static void transpose(Word * a) noexcept {
+        Word mask = 0x00000000ffffffffu;
+        for (size_t j = 32u; j != 0u; j >>= 1u, mask ^= mask << j) {
+            for (size_t r = 0u; r < 64u; r = ((r | j) + 1u) & ~j) {
+                const Word t = ((a[r] >> j) ^ a[r | j]) & mask;
+                a[r | j] ^= t;
+                a[r] ^= t << j;
+            }
+        }
+    }
+
+    /*
+     * Splits rows [begin, end) of the matrix into bit planes, 64 columns at
+     * a time. Plane p starts at planes + p * planeSize.
+     */
+    static void toPlanes(const U * matrix,
+                         size_t begin,
+                         size_t end,
+                         size_t cols,
+                         size_t rowWords,
+                         size_t planeSize,
+                         Word * planes) noexcept
+    {
+        Word block[WORD_BITS];
+        for (size_t r = begin; r < end; ++ r) {
+            for (size_t w = 0u; w < rowWords; ++ w) {
+                const size_t first = w * WORD_BITS;
+                const size_t count = std::min(size_t(WORD_BITS), cols - first);
+                std::fill(block + count, block + WORD_BITS, Word(0u));
+                for (size_t i = 0u; i < count; ++ i)
+                    block[i] = matrix[r * cols + first + i];
+
+                transpose(block);
+
+                for (size_t bit = 0u; bit < PLANES; ++ bit)
+                    planes[bit * planeSize + r * rowWords + w] = block[bit];
+            }
+        }
+    }
+
+    /* Inverse of toPlanes. */
+    static void fromPlanes(const Word * planes,
+                           size_t begin,
+                           size_t end,
+                           size_t cols,
+                           size_t rowWords,
+                           size_t planeSize,
+                           U * matrix) noexcept
+    {
+        Word block[WORD_BITS];
+        for (size_t r = begin; r < end; ++ r) {
+            for (size_t w = 0u; w < rowWords; ++ w) {
+                for (size_t bit = 0u; bit < PLANES; ++ bit)
+                    block[bit] = planes[bit * planeSize + r * rowWords + w];
+                std::fill(block + PLANES, block + WORD_BITS, Word(0u));
+
+                transpose(block);
+
+                const size_t first = w * WORD_BITS;
+                const size_t count = std::min(size_t(WORD_BITS), cols - first);
+                for (size_t i = 0u; i < count; ++ i)
+                    matrix[r * cols + first + i] = static_cast<U>(block[i]);
+            }
+        }
+    }
+
+    static void multiplyPlane(const Word * aBits,
+                              const Word * bBits,
+                              Word * cBits,
+                              Word * tables,
+                              size_t m,
+                              size_t k,
+                              size_t kw,
+                              size_t nw) noexcept
+    {
+        static_assert(TABLES == 4u && WORD_BITS % (8u * TABLES) == 0u, "");
+
+        for (size_t l0 = 0u; l0 < k; l0 += 8u * TABLES) {
+            // Build the tables in Gray code order, rows past k are zero:
+            for (size_t t = 0u; t < TABLES; ++ t) {
+                Word * const table = tables + t * TABLE_ROWS * nw;
+                std::fill(table, table + nw, Word(0u));
+                for (size_t x = 1u; x < TABLE_ROWS; ++ x) {
+                    Word * const dst = table + x * nw;
+                    const Word * const src = table + (x & (x - 1u)) * nw;
+                    const size_t l = l0 + 8u * t + __builtin_ctz(x);
+                    if (l < k) {
+                        const Word * const bRow = bBits + l * nw;
+                        for (size_t w = 0u; w < nw; ++ w)
+                            dst[w] = src[w] ^ bRow[w];
+                    } else {
+                        std::copy(src, src + nw, dst);
+                    }
+                }
+            }
+
+            const Word * const t0 = tables;
+            const Word * const t1 = t0 + TABLE_ROWS * nw;
+            const Word * const t2 = t1 + TABLE_ROWS * nw;
+            const Word * const t3 = t2 + TABLE_ROWS * nw;
+            const size_t shift = l0 % WORD_BITS;
+            for (size_t j = 0u; j < m; ++ j) {
+                const Word bits = aBits[j * kw + l0 / WORD_BITS] >> shift;
+                const Word * const r0 = t0 + (bits & 0xffu) * nw;
+                const Word * const r1 = t1 + ((bits >> 8u) & 0xffu) * nw;
+                const Word * const r2 = t2 + ((bits >> 16u) & 0xffu) * nw;
+                const Word * const r3 = t3 + ((bits >> 24u) & 0xffu) * nw;
+                Word * const cRow = cBits + j * nw;
+                for (size_t w = 0u; w < nw; ++ w)
+                    cRow[w] ^= r0[w] ^ r1[w] ^ r2[w] ^ r3[w];
+            }
+        }
+    }
+
+}; /* class BitMatrixMultiplication { */
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_PROTOCOLS_BITMATRIXMULTIPLICATION_H */
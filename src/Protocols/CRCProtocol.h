@@ -20,21 +20,37 @@
 #ifndef MOD_SHARED3P_EMU_PROTOCOLS_CRCPROTOCOL_H
 #define MOD_SHARED3P_EMU_PROTOCOLS_CRCPROTOCOL_H
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 #include "../Shared3pValueTraits.h"
 #include "../Shared3pVector.h"
+#include "../Shared3pPDPI.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#endif
 
 
 namespace sharemind {
 
+/** Number of bytes consumed by a single step of the table driven CRC. */
+constexpr size_t CRC_SLICES = 16u;
+
 template <CRCMode mode>
 struct __attribute__ ((visibility("internal"))) CRCModeInfo {};
 
+/*
+ * table[0] is the ordinary byte-at-a-time table, table[k][n] is the CRC of
+ * the byte n followed by k zero bytes.
+ */
 template <>
 struct __attribute__ ((visibility("internal"))) CRCModeInfo<CRCMode16> {
     typedef s3p_xor_uint16_t value_t;
     typedef ValueTraits<value_t>::share_type share_type;
     enum { POLY = static_cast<share_type>(0x8408) };
-    static share_type table[256];
+    static share_type table[CRC_SLICES][256];
 };
 
 template <>
@@ -42,29 +58,262 @@ struct __attribute__ ((visibility("internal"))) CRCModeInfo<CRCMode32> {
     typedef s3p_xor_uint32_t value_t;
     typedef ValueTraits<value_t>::share_type share_type;
     enum { POLY = static_cast<share_type>(0xedb88320) };
-    static share_type table[256];
+    static share_type table[CRC_SLICES][256];
 };
 
+namespace /* anonymous */ {
+
+/* Advances the CRC register over the data, CRC_SLICES bytes at a time. */
+template <CRCMode mode>
+typename CRCModeInfo<mode>::share_type crcSlicing(
+        typename CRCModeInfo<mode>::share_type crc,
+        const uint8_t * data,
+        size_t size) noexcept
+{
+    typedef typename CRCModeInfo<mode>::share_type share_type;
+    const auto & table = CRCModeInfo<mode>::table;
+
+    for (; size >= CRC_SLICES; size -= CRC_SLICES, data += CRC_SLICES) {
+        uint8_t bytes[CRC_SLICES];
+        std::copy(data, data + CRC_SLICES, bytes);
+        for (size_t i = 0u; i < sizeof(share_type); ++ i)
+            bytes[i] ^= static_cast<uint8_t>(crc >> (8u * i));
+
+        share_type next = 0u;
+        for (size_t i = 0u; i < CRC_SLICES; ++ i)
+            next ^= table[CRC_SLICES - 1u - i][bytes[i]];
+        crc = next;
+    }
+
+    for (; size != 0u; -- size, ++ data)
+        crc = (crc >> 8) ^ table[0][(crc ^ *data) & 0xff];
+
+    return crc;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+inline bool haveCarryLessMultiply() noexcept {
+    static const bool supported = __builtin_cpu_supports("pclmul")
+                                  && __builtin_cpu_supports("sse4.1");
+    return supported;
+}
+
+__attribute__ ((target("sse2")))
+inline __m128i crcLoad(const uint8_t * p) noexcept
+{ return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+
+/* Multiplies the halves of x by the constants in k and adds y. */
+__attribute__ ((target("pclmul,sse2")))
+inline __m128i crcFold(const __m128i x, const __m128i k, const __m128i y) noexcept {
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                                       _mm_clmulepi64_si128(x, k, 0x11)),
+                         y);
+}
+
+/*
+ * Advances the CRC-32 register over the data by folding it with carry-less
+ * multiplications, four 16 byte lanes at a time, followed by a Barrett
+ * reduction. The size must be a multiple of 16 and at least 64. See "Fast CRC
+ * Computation for Generic Polynomials Using PCLMULQDQ Instruction" by Gopal
+ * et al.
+ */
+__attribute__ ((target("pclmul,sse4.1")))
+inline uint32_t crc32CarryLess(uint32_t crc, const uint8_t * data, size_t size) noexcept {
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0x0000000000, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i low32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_xor_si128(crcLoad(data), _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x2 = crcLoad(data + 16u);
+    __m128i x3 = crcLoad(data + 32u);
+    __m128i x4 = crcLoad(data + 48u);
+    data += 64u;
+    size -= 64u;
+
+    for (; size >= 64u; size -= 64u, data += 64u) {
+        x1 = crcFold(x1, k1k2, crcLoad(data));
+        x2 = crcFold(x2, k1k2, crcLoad(data + 16u));
+        x3 = crcFold(x3, k1k2, crcLoad(data + 32u));
+        x4 = crcFold(x4, k1k2, crcLoad(data + 48u));
+    }
+
+    // Fold the four lanes into one:
+    x1 = crcFold(x1, k3k4, x2);
+    x1 = crcFold(x1, k3k4, x3);
+    x1 = crcFold(x1, k3k4, x4);
+    for (; size >= 16u; size -= 16u, data += 16u)
+        x1 = crcFold(x1, k3k4, crcLoad(data));
+
+    // Fold 128 bits to 64 bits:
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, low32);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k5k0, 0x00), x2);
+
+    // Barrett reduction to 32 bits:
+    x2 = _mm_and_si128(x1, low32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, low32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+#endif
+
+template <CRCMode mode>
+inline typename CRCModeInfo<mode>::share_type crcUpdate(
+        typename CRCModeInfo<mode>::share_type crc,
+        const uint8_t * data,
+        size_t size) noexcept
+{
+    return crcSlicing<mode>(crc, data, size);
+}
+
+template <>
+inline uint32_t crcUpdate<CRCMode32>(uint32_t crc,
+                                     const uint8_t * data,
+                                     size_t size) noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (size >= 64u && haveCarryLessMultiply()) {
+        const size_t folded = size & ~size_t(15u);
+        crc = crc32CarryLess(crc, data, folded);
+        data += folded;
+        size -= folded;
+    }
+#endif
+    return crcSlicing<CRCMode32>(crc, data, size);
+}
+
+/* Product of a and b modulo the polynomial, in the reflected bit order. */
+template <CRCMode mode>
+typename CRCModeInfo<mode>::share_type crcMultiply(
+        typename CRCModeInfo<mode>::share_type a,
+        typename CRCModeInfo<mode>::share_type b) noexcept
+{
+    typedef typename CRCModeInfo<mode>::share_type share_type;
+    constexpr share_type one = share_type(1u) << (8u * sizeof(share_type) - 1u);
+    constexpr share_type poly = static_cast<share_type>(CRCModeInfo<mode>::POLY);
+
+    share_type p = 0u;
+    for (share_type m = one; m != 0u; m >>= 1) {
+        if (a & m)
+            p ^= b;
+        b = (b & 1u) ? static_cast<share_type>((b >> 1) ^ poly)
+                     : static_cast<share_type>(b >> 1);
+    }
+
+    return p;
+}
+
+/* The CRC register after processing n zero bytes. */
+template <CRCMode mode>
+typename CRCModeInfo<mode>::share_type crcShift(
+        typename CRCModeInfo<mode>::share_type crc,
+        size_t n) noexcept
+{
+    typedef typename CRCModeInfo<mode>::share_type share_type;
+    constexpr unsigned bits = 8u * sizeof(share_type);
+
+    share_type power = share_type(1u) << (bits - 9u); // x^8
+    share_type shift = share_type(1u) << (bits - 1u); // x^0
+    for (; n != 0u; n >>= 1, power = crcMultiply<mode>(power, power))
+        if (n & 1u)
+            shift = crcMultiply<mode>(shift, power);
+
+    return crcMultiply<mode>(shift, crc);
+}
+
+} /* namespace anonymous */
+
 template <CRCMode mode>
 class __attribute__ ((visibility("internal"))) CRCProtocol {};
 
+/*
+ * Long inputs are split into chunks, the CRC register of each chunk is
+ * computed from zero in parallel and the chunks are combined using the
+ * linearity of the CRC:
+ *   crc(r, A || B) = crc(r, A) * x^(8 |B|) + crc(0, B).
+ */
 template <CRCMode mode>
 class __attribute__ ((visibility("internal"))) CRCProtocolBase {
 
+private: /* Types: */
+
+    typedef typename CRCModeInfo<mode>::share_type share_type;
+
+    /* Input is copied to a local buffer of this size for processing: */
+    static constexpr size_t BUFFER_SIZE = 16384u;
+
+    static constexpr size_t MIN_CHUNK_SIZE = 1u << 20u;
+
 public: /* Methods: */
 
+    CRCProtocolBase(Shared3pPDPI & pdpi)
+        : m_pdpi(pdpi)
+    {}
+
     bool invoke(const ShareVec<s3p_xor_uint8_t> & src,
-                typename CRCModeInfo<mode>::share_type & dest)
+                share_type & dest)
     {
-        typedef typename CRCModeInfo<mode>::share_type share_type;
+        ThreadPool & pool = m_pdpi.threadPool();
+        const size_t size = src.size();
+        const size_t chunks =
+                std::max(size_t(1u),
+                         std::min(pool.numThreads(), size / MIN_CHUNK_SIZE));
+
+        if (chunks == 1u) {
+            dest = ~update(~dest, src, 0u, size);
+            return true;
+        }
+
+        const size_t chunkSize = (size + chunks - 1u) / chunks;
+        std::vector<share_type> crcs(chunks);
+        pool.parallelFor(chunks, 1u, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++ i)
+                crcs[i] = update(0u, src, i * chunkSize,
+                                 std::min(size, (i + 1u) * chunkSize));
+        });
+
         share_type crc = ~dest;
-        for (size_t i = 0; i < src.size(); ++ i) {
-            crc = (crc >> 8) ^ CRCModeInfo<mode>::table[(crc ^ static_cast<share_type>(src[i])) & 0xff];
+        for (size_t i = 0u; i < chunks; ++ i) {
+            const size_t length =
+                    std::min(size, (i + 1u) * chunkSize) - i * chunkSize;
+            crc = crcShift<mode>(crc, length) ^ crcs[i];
         }
 
         dest = ~crc;
         return true;
     }
+
+private: /* Methods: */
+
+    static share_type update(share_type crc,
+                             const ShareVec<s3p_xor_uint8_t> & src,
+                             size_t begin,
+                             size_t end)
+    {
+        uint8_t buffer[BUFFER_SIZE];
+        while (begin < end) {
+            const size_t n = std::min(size_t(BUFFER_SIZE), end - begin);
+            std::copy(src.begin() + begin, src.begin() + begin + n, buffer);
+            crc = crcUpdate<mode>(crc, buffer, n);
+            begin += n;
+        }
+
+        return crc;
+    }
+
+private: /* Fields: */
+
+    Shared3pPDPI & m_pdpi;
+
 }; /* class CRCProtocolBase { */
 
 template <>
@@ -74,6 +323,8 @@ class __attribute__ ((visibility("internal"))) CRCProtocol<CRCMode16>
 
 public: /* Methods: */
 
+    using CRCProtocolBase<CRCMode16>::CRCProtocolBase;
+
 }; /* class CRCProtocol<CRCMode16> { */
 
 template <>
@@ -83,6 +334,8 @@ class __attribute__ ((visibility("internal"))) CRCProtocol<CRCMode32>
 
 public: /* Methods: */
 
+    using CRCProtocolBase<CRCMode32>::CRCProtocolBase;
+
 }; /* class CRCProtocol<CRCMode32> { */
 
 } /* namespace sharemind */
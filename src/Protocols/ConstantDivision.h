@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef MOD_SHARED3P_EMU_PROTOCOLS_CONSTANTDIVISION_H
+#define MOD_SHARED3P_EMU_PROTOCOLS_CONSTANTDIVISION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <sharemind/VmVector.h>
+#include <type_traits>
+#include "../Shared3pValueTraits.h"
+#include "../Shared3pVector.h"
+
+
+namespace sharemind {
+
+template <typename U> struct DoubleWidth {};
+template <> struct DoubleWidth<uint8_t> { using type = uint16_t; };
+template <> struct DoubleWidth<uint16_t> { using type = uint32_t; };
+template <> struct DoubleWidth<uint32_t> { using type = uint64_t; };
+template <> struct DoubleWidth<uint64_t> { using type = unsigned __int128; };
+
+/**
+ * \brief Unsigned division by a fixed divisor as a multiplication and shifts.
+ *
+ * With l = ceil(log2(d)) and m = floor(2^N * (2^l - d) / d) + 1 the quotient
+ * of an N-bit x is (t + ((x - t) >> min(l, 1))) >> max(l - 1, 0) where t is
+ * the high half of m * x. See "Division by Invariant Integers using
+ * Multiplication" by Granlund and Montgomery.
+ */
+template <typename U>
+class __attribute__ ((visibility("internal"))) ConstantDivisor {
+
+    static_assert(std::is_unsigned<U>::value, "");
+
+private: /* Types: */
+
+    using Wide = typename DoubleWidth<U>::type;
+
+    static constexpr unsigned BITS = 8u * sizeof(U);
+
+public: /* Methods: */
+
+    explicit ConstantDivisor(U d) noexcept
+        : m_divisor(d)
+    {
+        unsigned l = 0u;
+        while (l < BITS && (Wide(1u) << l) < d)
+            ++l;
+
+        m_multiplier = static_cast<U>(
+                ((Wide(1u) << BITS) * ((Wide(1u) << l) - d)) / d + 1u);
+        m_shift1 = std::min(l, 1u);
+        m_shift2 = l > 0u ? l - 1u : 0u;
+    }
+
+    U divide(U x) const noexcept {
+        const U t = static_cast<U>((Wide(m_multiplier) * x) >> BITS);
+        return static_cast<U>((t + static_cast<U>((x - t) >> m_shift1)) >> m_shift2);
+    }
+
+    U remainder(U x) const noexcept
+    { return static_cast<U>(x - divide(x) * m_divisor); }
+
+private: /* Fields: */
+
+    U m_divisor;
+    U m_multiplier;
+    unsigned m_shift1;
+    unsigned m_shift2;
+
+}; /* class ConstantDivisor { */
+
+struct __attribute__ ((visibility("internal"))) PublicQuotient {
+    template <typename U>
+    static U constant(const ConstantDivisor<U> & d, U x) noexcept
+    { return d.divide(x); }
+
+    template <typename U>
+    static U native(U x, U d) noexcept { return x / d; }
+};
+
+struct __attribute__ ((visibility("internal"))) PublicRemainder {
+    template <typename U>
+    static U constant(const ConstantDivisor<U> & d, U x) noexcept
+    { return d.remainder(x); }
+
+    template <typename U>
+    static U native(U x, U d) noexcept { return x % d; }
+};
+
+/*
+ * Returns the length of the leading blocks of param2 whose elements all equal
+ * the nonzero param2[0], or 0 if the divisors are signed. Comparing with the
+ * nonzero param2[0] also serves as the zero check.
+ */
+template <typename T>
+size_t uniformDivisorPrefix(const ImmutableVmVec<T> & param2,
+                            size_t size,
+                            std::true_type)
+{
+    using S = typename ValueTraits<T>::share_type;
+    constexpr size_t BLOCK_SIZE = 64u;
+
+    if (size == 0u || param2[0u] == 0u)
+        return 0u;
+
+    const S d = param2[0u];
+    size_t begin = 0u;
+    for (; begin < size; begin += BLOCK_SIZE) {
+        const size_t n = std::min(size - begin, BLOCK_SIZE);
+
+        S mismatch = 0u;
+        for (size_t k = 0u; k < n; ++k)
+            mismatch |= static_cast<S>(param2[begin + k] ^ d);
+        if (mismatch != 0u)
+            break;
+    }
+
+    return std::min(begin, size);
+}
+
+template <typename T>
+size_t uniformDivisorPrefix(const ImmutableVmVec<T> &, size_t, std::false_type)
+{ return 0u; }
+
+/* Divides the first size elements of param1 by d with a reciprocal. */
+template <typename Op, typename T, typename S>
+void divideUniform(const ShareVec<T> & param1,
+                   S d,
+                   size_t size,
+                   ShareVec<T> & result,
+                   std::true_type)
+{
+    constexpr size_t BLOCK_SIZE = 64u;
+
+    const ConstantDivisor<S> divisor(d);
+    S a[BLOCK_SIZE] = {}, z[BLOCK_SIZE];
+
+    for (size_t begin = 0u; begin < size; begin += BLOCK_SIZE) {
+        const size_t n = std::min(size - begin, BLOCK_SIZE);
+
+        for (size_t k = 0u; k < n; ++k)
+            a[k] = param1[begin + k];
+        // A full block even at the end, the loop vectorizes better:
+        for (size_t k = 0u; k < BLOCK_SIZE; ++k)
+            z[k] = Op::constant(divisor, a[k]);
+        for (size_t k = 0u; k < n; ++k)
+            result[begin + k] = z[k];
+    }
+}
+
+template <typename Op, typename T, typename S>
+void divideUniform(const ShareVec<T> &,
+                   S,
+                   size_t,
+                   ShareVec<T> &,
+                   std::false_type)
+{}
+
+/**
+ * \brief Sets result[i] = Op(param1[i], param2[i]) for public divisors.
+ *
+ * Fails without writing the result if any of the divisors is zero. Unsigned
+ * values are divided with a precomputed reciprocal for as long as the
+ * divisors repeat param2[0], the rest of the vector is divided elementwise.
+ */
+template <typename Op, typename T>
+bool divideByPublic(const ShareVec<T> & param1,
+                    const ImmutableVmVec<T> & param2,
+                    ShareVec<T> & result)
+{
+    using S = typename ValueTraits<T>::share_type;
+
+    const size_t size = param1.size();
+    const size_t begin = uniformDivisorPrefix(param2, size,
+                                              std::is_unsigned<S>());
+
+    for (size_t i = begin; i < size; ++i) {
+        if (param2[i] == 0)
+            return false;
+    }
+
+    if (begin != 0u)
+        divideUniform<Op>(param1, S(param2[0u]), begin, result,
+                          std::is_unsigned<S>());
+
+    for (size_t i = begin; i < size; ++i)
+        result[i] = Op::native(S(param1[i]), S(param2[i]));
+
+    return true;
+}
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_PROTOCOLS_CONSTANTDIVISION_H */
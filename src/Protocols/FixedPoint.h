@@ -20,7 +20,13 @@
 #ifndef MOD_SHARED3P_EMU_PROTOCOLS_FIXEDPOINT_H
 #define MOD_SHARED3P_EMU_PROTOCOLS_FIXEDPOINT_H
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <sharemind/uint128_t.h>
+#include <type_traits>
 #include "../Shared3pPDPI.h"
 #include "../Shared3pValueTraits.h"
 #include "SoftFloatUtility.h"
@@ -61,19 +67,177 @@ struct __attribute__ ((visibility("internal"))) Radix<uint64_t> {
     static constexpr uint64_t value = 32;
 };
 
+/* Significand bits of the float type that the fixed point type maps to. */
 template<typename T>
-struct __attribute__ ((visibility("internal"))) respective_float_type;
+struct __attribute__ ((visibility("internal"))) Precision;
 
 template<>
-struct __attribute__ ((visibility("internal"))) respective_float_type<sharemind::s3p_uint32_t> {
-    using type = sharemind::s3p_float32_t;
+struct __attribute__ ((visibility("internal"))) Precision<uint32_t> {
+    static constexpr unsigned value = 24;
 };
 
 template<>
-struct __attribute__ ((visibility("internal"))) respective_float_type<sharemind::s3p_uint64_t> {
-    using type = sharemind::s3p_float64_t;
+struct __attribute__ ((visibility("internal"))) Precision<uint64_t> {
+    static constexpr unsigned value = 53;
 };
 
+/*
+ * The inverse and square root of fixed point values are defined by the
+ * LibSoftfloat round-trip they used to be computed with: the value is
+ * converted to the float of Precision<Uint>::value significand bits
+ * (rounding to nearest even), the operation is rounded to nearest even, and
+ * the result is scaled back and truncated. Overflows and NaN saturate to the
+ * largest value unless the result is negative. The functions below compute
+ * exactly that with integers: the quotient or root is computed with two
+ * extra bits and a sticky bit, rounded to the precision and truncated.
+ *
+ * The quotients and roots have at most precision + 2 <= 55 bits. They are
+ * estimated in double precision, which is within two units of the exact
+ * value, and corrected with as many steps in either direction. The
+ * remainders are small, so they can be computed modulo 2^64.
+ */
+
+constexpr unsigned ESTIMATE_SLACK = 2u;
+
+inline unsigned bitLength(uint64_t x) noexcept {
+    return x == 0u ? 0u : 64u - static_cast<unsigned>(__builtin_clzll(x));
+}
+
+/* 2^e as a double, for 0 <= e < 1024. */
+inline double powerOfTwo(unsigned e) noexcept {
+    const uint64_t bits = static_cast<uint64_t>(1023u + e) << 52u;
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+/* x * 2^e modulo 2^64. */
+inline uint64_t shiftLeft(uint64_t x, unsigned e) noexcept {
+    return e < 64u ? x << e : 0u;
+}
+
+/*
+ * Rounds m to the nearest value of the form a * 2^k with a < 2^precision.
+ * The data dependent branches are avoided, they would be mispredicted.
+ */
+inline uint64_t roundToPrecision(uint64_t m, unsigned precision, unsigned & k)
+    noexcept
+{
+    const unsigned length = bitLength(m);
+    k = length > precision ? length - precision : 0u;
+
+    const uint64_t a = m >> k;
+    const uint64_t unit = uint64_t(1u) << k;
+    const uint64_t rest2 = 2u * (m & (unit - 1u));
+    return a + ((rest2 > unit) | ((rest2 == unit) & a & 1u));
+}
+
+/*
+ * Rounds (q + f) * 2^-e where 0 <= f < 1 and f > 0 iff sticky to the given
+ * precision and truncates it. Results of at least 2^(bits - 1) are returned
+ * as 2^(bits - 1).
+ */
+inline uint64_t roundAndTruncate(uint64_t q,
+                                 bool sticky,
+                                 int e,
+                                 unsigned precision,
+                                 unsigned bits) noexcept
+{
+    const unsigned d = bitLength(q) - precision;
+    const uint64_t rest = q & ((uint64_t(1u) << d) - 1u);
+    const uint64_t half = uint64_t(1u) << (d - 1u);
+    uint64_t r = q >> d;
+    r += (rest > half) | ((rest == half) & (sticky | (r & 1u)));
+
+    // The rounded value r has at most precision + 1 < 63 bits:
+    const int shift = static_cast<int>(d) - e;
+    const unsigned left = static_cast<unsigned>(std::min(std::max(shift, 0), 63));
+    const unsigned right = static_cast<unsigned>(std::min(std::max(-shift, 0), 63));
+    const bool overflow = bitLength(r) + left > bits - 1u;
+    return overflow ? uint64_t(1u) << (bits - 1u) : (r << left) >> right;
+}
+
+/* Applies the sign and the saturation of the float to integer conversion. */
+template<typename Uint>
+Uint signedResult(uint64_t magnitude, bool negative) noexcept {
+    const uint64_t limit = uint64_t(1u) << (8u * sizeof(Uint) - 1u);
+    const uint64_t capped = std::min(magnitude, limit);
+    return static_cast<Uint>(negative ? uint64_t(0u) - capped
+                                      : capped - (capped == limit));
+}
+
+/* Returns the fixed point 1 / x. */
+template<typename Uint>
+Uint fixInverse(Uint x) noexcept {
+    using Int = typename std::make_signed<Uint>::type;
+    constexpr unsigned precision = Precision<Uint>::value;
+    constexpr unsigned radix = Radix<Uint>::value;
+    constexpr unsigned bits = 8u * sizeof(Uint);
+
+    const Int xi = static_cast<Int>(x);
+    if (xi == 0)
+        return static_cast<Uint>(std::numeric_limits<Int>::max());
+
+    const bool negative = xi < 0;
+    const uint64_t m = negative ? uint64_t(0u) - static_cast<uint64_t>(xi)
+                                : static_cast<uint64_t>(xi);
+
+    // 2^(2 * radix) / (a * 2^k) with the quotient of 2^j / a in
+    // (2^(precision + 1), 2^(precision + 2)]:
+    unsigned k;
+    const uint64_t a = roundToPrecision(m, precision, k);
+    const unsigned j = bitLength(a) + precision + 1u;
+
+    uint64_t q = static_cast<uint64_t>(powerOfTwo(j) / static_cast<double>(a))
+                 - ESTIMATE_SLACK;
+    uint64_t rem = shiftLeft(1u, j) - q * a;
+    for (unsigned i = 0u; i < 2u * ESTIMATE_SLACK; ++i) {
+        const bool up = rem >= a;
+        q += up;
+        rem -= up ? a : 0u;
+    }
+
+    const int e = static_cast<int>(j + k) - static_cast<int>(2u * radix);
+    return signedResult<Uint>(
+            roundAndTruncate(q, rem != 0u, e, precision, bits), negative);
+}
+
+/* Returns the fixed point square root of x. */
+template<typename Uint>
+Uint fixSquareRoot(Uint x) noexcept {
+    using Int = typename std::make_signed<Uint>::type;
+    constexpr unsigned precision = Precision<Uint>::value;
+    constexpr unsigned radix = Radix<Uint>::value;
+    constexpr unsigned bits = 8u * sizeof(Uint);
+
+    const Int xi = static_cast<Int>(x);
+    if (xi < 0)
+        return static_cast<Uint>(std::numeric_limits<Int>::max());
+    if (xi == 0)
+        return 0u;
+
+    // sqrt(a * 2^(k + radix)) = sqrt(a * 2^s) * 2^-t with s = k + radix + 2t
+    // and the root of a * 2^s in [2^(precision + 1), 2^(precision + 2)):
+    unsigned k;
+    const uint64_t a = roundToPrecision(static_cast<uint64_t>(xi), precision, k);
+    unsigned s = 2u * precision + 3u - bitLength(a);
+    s += (s - k - radix) % 2u;
+
+    uint64_t q = static_cast<uint64_t>(
+            std::sqrt(static_cast<double>(a) * powerOfTwo(s))) - ESTIMATE_SLACK;
+    uint64_t rem = shiftLeft(a, s) - q * q;
+    for (unsigned i = 0u; i < 2u * ESTIMATE_SLACK; ++i) {
+        const uint64_t step = 2u * q + 1u;
+        const bool up = rem >= step;
+        q += up;
+        rem -= up ? step : 0u;
+    }
+
+    const int e = static_cast<int>((s - k - radix) / 2u);
+    return signedResult<Uint>(
+            roundAndTruncate(q, rem != 0u, e, precision, bits), false);
+}
+
 } /* namespace FixedPointHelper */
 
 namespace sharemind {
@@ -209,8 +373,7 @@ class __attribute__ ((visibility("internal"))) FixInverseProtocol {
 
 public: /* Methods: */
 
-    FixInverseProtocol(const Shared3pPDPI& pdpi)
-        : m_pdpi(pdpi) {}
+    FixInverseProtocol(const Shared3pPDPI& pdpi) { (void) pdpi; }
 
     template<typename Uint>
     typename std::enable_if<is_unsigned_value_tag<Uint>::value, bool>::type
@@ -222,32 +385,20 @@ public: /* Methods: */
         if (param.size() != result.size())
             return false;
 
-        using Float = typename respective_float_type<Uint>::type;
-
-        ShareVec<Float> floats(param.size());
-
-        FixToFloatProtocol(m_pdpi).invoke(param, floats);
-
-        for (size_t i = 0u; i < param.size(); ++i) {
-            floats[i] = sf_float_inv(floats[i]).result;
-        }
+        using S = typename Uint::share_type;
 
-        FloatToFixProtocol(m_pdpi).invoke(floats, result);
+        for (size_t i = 0u; i < param.size(); ++i)
+            result[i] = fixInverse<S>(param[i]);
 
         return true;
     }
-
-private: /* Fields: */
-
-    const Shared3pPDPI& m_pdpi;
 };
 
 class __attribute__ ((visibility("internal"))) FixSquareRootProtocol {
 
 public: /* Methods: */
 
-    FixSquareRootProtocol(const Shared3pPDPI& pdpi)
-        : m_pdpi(pdpi) {}
+    FixSquareRootProtocol(const Shared3pPDPI& pdpi) { (void) pdpi; }
 
     template<typename Uint>
     typename std::enable_if<is_unsigned_value_tag<Uint>::value, bool>::type
@@ -259,25 +410,13 @@ public: /* Methods: */
         if (param.size() != result.size())
             return false;
 
-        using Float = typename respective_float_type<Uint>::type;
+        using S = typename Uint::share_type;
 
-        ShareVec<Float> floats(param.size());
-
-        FixToFloatProtocol(m_pdpi).invoke(param, floats);
-
-        for (size_t i = 0u; i < param.size(); ++i) {
-            floats[i] = sf_float_sqrt(floats[i]).result;
-        }
-
-        FloatToFixProtocol(m_pdpi).invoke(floats, result);
+        for (size_t i = 0u; i < param.size(); ++i)
+            result[i] = fixSquareRoot<S>(param[i]);
 
         return true;
     }
-
-private: /* Fields: */
-
-    const Shared3pPDPI& m_pdpi;
-
 };
 
 template<typename Uint, typename Float>
@@ -21,18 +21,63 @@
 #define MOD_SHARED3P_EMU_PROTOCOLS_MATRIXMULTIPLICATIONPROTOCOL_H
 
 #include <algorithm>
-#include <numeric>
-#include <random>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
 #include "../Shared3pValueTraits.h"
 #include "../Shared3pVector.h"
 #include "../Shared3pPDPI.h"
+#include "BitMatrixMultiplication.h"
 
 
 namespace sharemind {
 
 class __attribute__ ((visibility("internal"))) MatrixMultiplicationProtocol {
+
+private: /* Types: */
+
+    /*
+     * Ordinary ring operations, computed modulo 2^n. Narrow operands would be
+     * promoted to int, so the product is computed in 64 bits to not overflow:
+     */
+    template <typename U>
+    struct NumericOps {
+        static constexpr bool bitwise = false;
+        static U add(U a, U b) noexcept { return U(a + b); }
+        static U mul(U a, U b) noexcept
+        { return U(static_cast<uint64_t>(a) * b); }
+    };
+
+    /* Addition is xor and multiplication is bitwise and: */
+    template <typename U>
+    struct XorOps {
+        static constexpr bool bitwise = true;
+        static U add(U a, U b) noexcept { return U(a ^ b); }
+        static U mul(U a, U b) noexcept { return U(a & b); }
+    };
+
+    /* Register block of the micro-kernel: */
+    static constexpr size_t MR = 4u;
+    static constexpr size_t NR = 4u;
+
+    /* Rows per task, depth of a packed panel and number of columns of B
+       that are kept in cache at a time: */
+    static constexpr size_t MC = 64u;
+    static constexpr size_t KC = 256u;
+    static constexpr size_t NC = 512u;
+
+    /* Matrices with fewer multiplications are computed directly: */
+    static constexpr size_t SMALL_MATRIX_OPS = 32u * 32u * 32u;
+
+    /* Bitwise products at least this tall and wide are bit sliced: */
+    static constexpr size_t BIT_MATRIX_MIN_DIM = 64u;
+
 public: /* Methods: */
 
+    MatrixMultiplicationProtocol(Shared3pPDPI & pdpi)
+        : m_pdpi(pdpi)
+    {}
+
     template <typename T>
     typename std::enable_if<is_integral_value_tag<T>::value, bool>::type
     invoke (const ShareVec<T>& mat1,
@@ -43,42 +88,10 @@ public: /* Methods: */
             ShareVec<T>& result,
             numeric_value_tag)
     {
-        // Transpose mat2 for better memory access later.
-        ShareVec<T> mat2T (mat2.size());
-
-        size_t s = 0;
-        for (size_t i = 0; i < dim1.size(); ++ i) {
-            for (size_t j = 0; j < dim2[i]; ++ j) {
-                for (size_t k = 0; k < dim3[i]; ++ k) {
-                    mat2T[s + k * dim2[i] + j] = mat2[s + j * dim3[i] + k];
-                }
-            }
-
-            s += dim2[i] * dim3[i];
-        }
-
-        size_t s1 = 0;
-        size_t s2 = 0;
-        size_t s3 = 0;
-        for (size_t i = 0; i < dim1.size(); ++ i) {
-            for (size_t j = 0; j < dim1[i]; ++ j) {
-                for (size_t k = 0; k < dim3[i]; ++ k) {
-                    const size_t t3 = s3 + j * dim3[i] + k;
-                    result[t3] = 0;
-                    for (size_t l = 0; l < dim2[i]; ++ l) {
-                        const size_t t1 = s1 + j * dim2[i] + l;
-                        const size_t t2 = s2 + k * dim2[i] + l;
-                        result[t3] += mat1[t1] * mat2T[t2];
-                    }
-                }
-            }
-
-            s1 += dim1[i] * dim2[i];
-            s2 += dim2[i] * dim3[i];
-            s3 += dim1[i] * dim3[i];
-        }
-
-        return true;
+        using U = typename std::make_unsigned<
+            typename ValueTraits<T>::share_type>::type;
+        return multiplyAll<NumericOps<U> >(mat1, mat2, dim1, dim2, dim3,
+                                           result);
     }
 
     /*
@@ -95,44 +108,234 @@ public: /* Methods: */
             ShareVec<T>& result,
             xored_numeric_value_tag)
     {
-        // Transpose mat2 for better memory access later.
-        ShareVec<T> mat2T (mat2.size());
+        using U = typename ValueTraits<T>::share_type;
+        return multiplyAll<XorOps<U> >(mat1, mat2, dim1, dim2, dim3, result);
+    }
 
-        size_t s = 0;
+private: /* Methods: */
+
+    template <typename Ops, typename T>
+    bool multiplyAll(const ShareVec<T>& mat1,
+                     const ShareVec<T>& mat2,
+                     const ImmutableVmVec<s3p_uint64_t>& dim1,
+                     const ImmutableVmVec<s3p_uint64_t>& dim2,
+                     const ImmutableVmVec<s3p_uint64_t>& dim3,
+                     ShareVec<T>& result)
+    {
+        size_t s1 = 0;
+        size_t s2 = 0;
+        size_t s3 = 0;
         for (size_t i = 0; i < dim1.size(); ++ i) {
-            for (size_t j = 0; j < dim2[i]; ++ j) {
-                for (size_t k = 0; k < dim3[i]; ++ k) {
-                    mat2T[s + k * dim2[i] + j] = mat2[s + j * dim3[i] + k];
+            const size_t m = dim1[i];
+            const size_t k = dim2[i];
+            const size_t n = dim3[i];
+
+            if (m * n * k < SMALL_MATRIX_OPS) {
+                multiplySmall<Ops>(mat1, mat2, result, s1, s2, s3, m, k, n);
+            } else if (Ops::bitwise &&
+                       m >= BIT_MATRIX_MIN_DIM &&
+                       n >= BIT_MATRIX_MIN_DIM)
+            {
+                multiplyBitSliced<Ops>(mat1, mat2, result,
+                                       s1, s2, s3, m, k, n);
+            } else {
+                multiplyTiled<Ops>(mat1, mat2, result, s1, s2, s3, m, k, n);
+            }
+
+            s1 += m * k;
+            s2 += k * n;
+            s3 += m * n;
+        }
+
+        return true;
+    }
+
+    template <typename Ops, typename T>
+    static void multiplySmall(const ShareVec<T>& mat1,
+                              const ShareVec<T>& mat2,
+                              ShareVec<T>& result,
+                              size_t s1, size_t s2, size_t s3,
+                              size_t m, size_t k, size_t n)
+    {
+        using U = decltype(Ops::add(0, 0));
+
+        std::vector<U> row(n);
+        for (size_t j = 0; j < m; ++ j) {
+            std::fill(row.begin(), row.end(), U(0u));
+            for (size_t l = 0; l < k; ++ l) {
+                const U a = static_cast<U>(mat1[s1 + j * k + l]);
+                for (size_t c = 0; c < n; ++ c) {
+                    const U b = static_cast<U>(mat2[s2 + l * n + c]);
+                    row[c] = Ops::add(row[c], Ops::mul(a, b));
                 }
             }
 
-            s += dim2[i] * dim3[i];
+            for (size_t c = 0; c < n; ++ c)
+                result[s3 + j * n + c] = row[c];
         }
+    }
 
-        size_t s1 = 0;
-        size_t s2 = 0;
-        size_t s3 = 0;
-        for (size_t i = 0; i < dim1.size(); ++ i) {
-            for (size_t j = 0; j < dim1[i]; ++ j) {
-                for (size_t k = 0; k < dim3[i]; ++ k) {
-                    const size_t t3 = s3 + j * dim3[i] + k;
-                    result[t3] = 0;
-                    for (size_t l = 0; l < dim2[i]; ++ l) {
-                        const size_t t1 = s1 + j * dim2[i] + l;
-                        const size_t t2 = s2 + k * dim2[i] + l;
-                        result[t3] ^= mat1[t1] & mat2T[t2];
+    template <typename Ops, typename T>
+    void multiplyBitSliced(const ShareVec<T>& mat1,
+                           const ShareVec<T>& mat2,
+                           ShareVec<T>& result,
+                           size_t s1, size_t s2, size_t s3,
+                           size_t m, size_t k, size_t n)
+    {
+        using U = decltype(Ops::add(0, 0));
+
+        std::vector<U> a(m * k);
+        std::vector<U> b(k * n);
+        std::vector<U> c(m * n);
+        for (size_t i = 0; i < a.size(); ++ i)
+            a[i] = static_cast<U>(mat1[s1 + i]);
+        for (size_t i = 0; i < b.size(); ++ i)
+            b[i] = static_cast<U>(mat2[s2 + i]);
+
+        BitMatrixMultiplication<U>::multiply(a.data(), b.data(), c.data(),
+                                             m, k, n, m_pdpi.threadPool());
+
+        for (size_t i = 0; i < c.size(); ++ i)
+            result[s3 + i] = c[i];
+    }
+
+    /*
+     * B is packed once into strips of NR columns (padded with zeroes) which
+     * are contiguous along the inner dimension. Tasks of MC rows of the
+     * result run on the thread pool. Each packs its rows of A one KC deep
+     * panel at a time into MR row strips and multiplies them with an NC
+     * wide block of B using an MR x NR register blocked micro-kernel.
+     */
+    template <typename Ops, typename T>
+    void multiplyTiled(const ShareVec<T>& mat1,
+                       const ShareVec<T>& mat2,
+                       ShareVec<T>& result,
+                       size_t s1, size_t s2, size_t s3,
+                       size_t m, size_t k, size_t n)
+    {
+        using U = decltype(Ops::add(0, 0));
+
+        const size_t numStrips = (n + NR - 1u) / NR;
+        std::vector<U> packedB(numStrips * k * NR, U(0u));
+        m_pdpi.threadPool().parallelFor(numStrips, 1u,
+            [&](size_t begin, size_t end) {
+                for (size_t js = begin; js < end; ++ js) {
+                    U * const strip = &packedB[js * k * NR];
+                    const size_t cols = std::min(size_t(NR), n - js * NR);
+                    for (size_t l = 0; l < k; ++ l) {
+                        for (size_t jj = 0; jj < cols; ++ jj) {
+                            strip[l * NR + jj] = static_cast<U>(
+                                mat2[s2 + l * n + js * NR + jj]);
+                        }
                     }
                 }
-            }
+            });
+
+        m_pdpi.threadPool().parallelFor(m, MC,
+            [&](size_t rowBegin, size_t rowEnd) {
+                const size_t rows = rowEnd - rowBegin;
+                const size_t rowStrips = (rows + MR - 1u) / MR;
+                std::vector<U> c(rows * n, U(0u));
+                std::vector<U> packedA(rowStrips * KC * MR);
+
+                for (size_t kb = 0; kb < k; kb += KC) {
+                    const size_t kc = std::min(size_t(KC), k - kb);
+
+                    std::fill(packedA.begin(), packedA.end(), U(0u));
+                    for (size_t is = 0; is < rowStrips; ++ is) {
+                        U * const strip = &packedA[is * kc * MR];
+                        const size_t stripRows =
+                            std::min(size_t(MR), rows - is * MR);
+                        for (size_t ii = 0; ii < stripRows; ++ ii) {
+                            const size_t t1 =
+                                s1 + (rowBegin + is * MR + ii) * k + kb;
+                            for (size_t l = 0; l < kc; ++ l)
+                                strip[l * MR + ii] =
+                                    static_cast<U>(mat1[t1 + l]);
+                        }
+                    }
 
-            s1 += dim1[i] * dim2[i];
-            s2 += dim2[i] * dim3[i];
-            s3 += dim1[i] * dim3[i];
+                    for (size_t jb = 0; jb < numStrips; jb += NC / NR) {
+                        const size_t jEnd = std::min(numStrips, jb + NC / NR);
+                        for (size_t is = 0; is < rowStrips; ++ is) {
+                            const size_t stripRows =
+                                std::min(size_t(MR), rows - is * MR);
+                            for (size_t js = jb; js < jEnd; ++ js) {
+                                microKernel<Ops>(
+                                        &packedA[is * kc * MR],
+                                        &packedB[js * k * NR + kb * NR],
+                                        kc,
+                                        &c[is * MR * n + js * NR],
+                                        n,
+                                        stripRows,
+                                        std::min(size_t(NR), n - js * NR));
+                            }
+                        }
+                    }
+                }
+
+                for (size_t i = 0; i < rows * n; ++ i)
+                    result[s3 + rowBegin * n + i] = c[i];
+            });
+    }
+
+    /*
+     * c[0..rows)[0..cols) += a (MR x kc) * b (kc x NR). The accumulators
+     * are spelled out so that they stay in registers.
+     */
+    template <typename Ops, typename U>
+    static void microKernel(const U * a,
+                            const U * b,
+                            size_t kc,
+                            U * c,
+                            size_t ldc,
+                            size_t rows,
+                            size_t cols) noexcept
+    {
+        static_assert(MR == 4u && NR == 4u, "");
+
+        U c00(0u), c01(0u), c02(0u), c03(0u);
+        U c10(0u), c11(0u), c12(0u), c13(0u);
+        U c20(0u), c21(0u), c22(0u), c23(0u);
+        U c30(0u), c31(0u), c32(0u), c33(0u);
+
+        for (size_t l = 0; l < kc; ++ l, a += MR, b += NR) {
+            const U b0 = b[0], b1 = b[1], b2 = b[2], b3 = b[3];
+            U av = a[0];
+            c00 = Ops::add(c00, Ops::mul(av, b0));
+            c01 = Ops::add(c01, Ops::mul(av, b1));
+            c02 = Ops::add(c02, Ops::mul(av, b2));
+            c03 = Ops::add(c03, Ops::mul(av, b3));
+            av = a[1];
+            c10 = Ops::add(c10, Ops::mul(av, b0));
+            c11 = Ops::add(c11, Ops::mul(av, b1));
+            c12 = Ops::add(c12, Ops::mul(av, b2));
+            c13 = Ops::add(c13, Ops::mul(av, b3));
+            av = a[2];
+            c20 = Ops::add(c20, Ops::mul(av, b0));
+            c21 = Ops::add(c21, Ops::mul(av, b1));
+            c22 = Ops::add(c22, Ops::mul(av, b2));
+            c23 = Ops::add(c23, Ops::mul(av, b3));
+            av = a[3];
+            c30 = Ops::add(c30, Ops::mul(av, b0));
+            c31 = Ops::add(c31, Ops::mul(av, b1));
+            c32 = Ops::add(c32, Ops::mul(av, b2));
+            c33 = Ops::add(c33, Ops::mul(av, b3));
         }
 
-        return true;
+        const U acc[MR][NR] = { { c00, c01, c02, c03 },
+                                { c10, c11, c12, c13 },
+                                { c20, c21, c22, c23 },
+                                { c30, c31, c32, c33 } };
+        for (size_t ii = 0; ii < rows; ++ ii)
+            for (size_t jj = 0; jj < cols; ++ jj)
+                c[ii * ldc + jj] = Ops::add(c[ii * ldc + jj], acc[ii][jj]);
     }
 
+private: /* Fields: */
+
+    Shared3pPDPI & m_pdpi;
+
 }; /* class MatrixMultiplicationProtocol { */
 
 } /* namespace sharemind { */
@@ -21,8 +21,9 @@
 #define MOD_SHARED3P_EMU_PROTOCOLS_MATRIXSHUFFLINGPROTOCOL_H
 
 #include <algorithm>
-#include <numeric>
-#include <random>
+#include <cstdint>
+#include <vector>
+#include "../Facilities/CxxRandomEngine.h"
 #include "../Shared3pValueTraits.h"
 #include "../Shared3pVector.h"
 #include "../Shared3pPDPI.h"
@@ -30,7 +31,78 @@
 
 namespace sharemind {
 
+namespace {
+
+/** Swap targets are computed in batches of this many rows. */
+constexpr size_t SHUFFLE_BATCH_ROWS = 1u << 14u;
+
+/** Computing a batch is split between the threads in chunks of this size. */
+constexpr size_t SHUFFLE_BATCH_GRAIN = 1u << 11u;
+
+/** The rows of this many swaps ahead are prefetched. */
+constexpr size_t SHUFFLE_PREFETCH_DISTANCE = 8u;
+
+/** The finalizer of SplitMix64. */
+inline uint64_t shuffleMix(uint64_t x) noexcept {
+    x ^= x >> 30u;
+    x *= UINT64_C(0xbf58476d1ce4e5b9);
+    x ^= x >> 27u;
+    x *= UINT64_C(0x94d049bb133111eb);
+    return x ^ (x >> 31u);
+}
+
+template <typename T>
+inline void prefetchRow(ShareVec<T> & vec, size_t offset) noexcept
+{ __builtin_prefetch(&vec[offset], 1); }
+
+/* Bits have no address: */
+inline void prefetchRow(ShareVec<s3p_bool_t> &, size_t) noexcept {}
+
+} /* anonymous namespace */
+
+/**
+ * Shuffles the rows of a matrix in place with the Fisher-Yates shuffle. The
+ * swap targets of the keyed shuffle are a hash of the key and the row
+ * index, so they are computed in parallel and in any order, and the inverse
+ * shuffle does the same swaps in the reverse order.
+ */
 class __attribute__ ((visibility("internal"))) MatrixShufflingProtocol {
+
+private: /* Types: */
+
+    /** The keyed swap targets of the Fisher-Yates shuffle. */
+    class SwapTargets {
+
+    public: /* Methods: */
+
+        explicit SwapTargets(const ShareVec<s3p_uint8_t> & key)
+            : m_key{}
+        {
+            for (size_t i = 0u; i < key.size(); ++i)
+                m_key[(i / 8u) % 4u] ^=
+                        static_cast<uint64_t>(key[i]) << (8u * (i % 8u));
+        }
+
+        explicit SwapTargets(CxxRandomEngine & rng)
+            : m_key{}
+        { rng.fillBytes(m_key, sizeof(m_key)); }
+
+        /** \returns the row swapped with row i, uniform in [0, i]. */
+        inline uint64_t operator()(uint64_t i) const noexcept {
+            uint64_t h = shuffleMix(i ^ m_key[0u]);
+            h = shuffleMix(h ^ m_key[1u]);
+            h = shuffleMix(h ^ m_key[2u]);
+            h = shuffleMix(h ^ m_key[3u]);
+            return static_cast<uint64_t>(
+                    (static_cast<unsigned __int128>(h) * (i + 1u)) >> 64u);
+        }
+
+    private: /* Fields: */
+
+        uint64_t m_key[4u];
+
+    }; /* class SwapTargets { */
+
 public: /* Methods: */
 
     MatrixShufflingProtocol(Shared3pPDPI & pdpi)
@@ -41,61 +113,81 @@ public: /* Methods: */
     void invoke(ShareVec<T> & inOut, const size_t rowSize,
                 const ShareVec<s3p_uint8_t> & rand)
     {
-        invoke(inOut, rowSize, rand, true);
+        shuffle(inOut, rowSize, SwapTargets(rand), true);
     }
 
     template <typename T>
     void invokeInverse(ShareVec<T> & inOut, const size_t rowSize,
                        const ShareVec<s3p_uint8_t> & rand)
     {
-        invoke(inOut, rowSize, rand, false);
+        shuffle(inOut, rowSize, SwapTargets(rand), false);
     }
 
     template <typename T>
     void invoke(ShareVec<T> & inOut, const size_t rowSize) {
-        ShareVec<s3p_uint8_t> rand(32);
-        rand.randomize(m_pdpi.rng());
-        invoke(inOut, rowSize, rand, false);
+        shuffle(inOut, rowSize, SwapTargets(m_pdpi.rng()), true);
     }
 
 private: /* Methods: */
 
+    /**
+     * The forward shuffle swaps row i with row targets(i) for i from the
+     * last row down to 1, the inverse does the same from 1 up. Only a batch
+     * of swap targets is kept in memory at a time.
+     */
     template <typename T>
-    void invoke(ShareVec<T> & inOut, const size_t rowSize,
-                 const ShareVec<s3p_uint8_t> & rand, bool dir)
+    void shuffle(ShareVec<T> & inOut, const size_t rowSize,
+                 const SwapTargets & targets, bool forward)
     {
-        std::vector<size_t> permut(inOut.size() / rowSize);
-        getPermutationMatrix(permut, rand);
-        shuffle(inOut, rowSize, permut, dir);
-    }
+        const size_t rows = inOut.size() / rowSize;
+        if (rows <= 1u)
+            return;
+
+        const size_t swaps = rows - 1u;
+        const bool parallel = rows >= m_pdpi.parallelThreshold();
+        std::vector<uint64_t> batch(std::min(swaps, SHUFFLE_BATCH_ROWS));
+
+        // The k-th swap is that of row swapRow(k):
+        const auto swapRow = [swaps, forward](size_t k) -> uint64_t
+                { return forward ? swaps - k : k + 1u; };
+
+        for (size_t first = 0u; first < swaps; first += batch.size()) {
+            const size_t count = std::min(batch.size(), swaps - first);
+            const auto computeTargets =
+                [&batch, &targets, &swapRow, first](size_t begin, size_t end) {
+                    for (size_t k = begin; k < end; ++k)
+                        batch[k] = targets(swapRow(first + k));
+                };
+            if (parallel) {
+                m_pdpi.threadPool().parallelFor(count, SHUFFLE_BATCH_GRAIN,
+                                                computeTargets);
+            } else {
+                computeTargets(0u, count);
+            }
 
-    void getPermutationMatrix(std::vector<size_t> & perm,
-                              const ShareVec<s3p_uint8_t> & key)
-    {
-        std::default_random_engine rng;
-        std::seed_seq seed(key.begin(), key.end());
-        rng.seed(seed);
-        std::iota(perm.begin(), perm.end(), 0u);
-        std::shuffle(perm.begin(), perm.end(), rng);
+            for (size_t k = 0u; k < count; ++k) {
+                if (k + SHUFFLE_PREFETCH_DISTANCE < count)
+                    prefetchRow(inOut,
+                                batch[k + SHUFFLE_PREFETCH_DISTANCE] * rowSize);
+                swapRows(inOut, swapRow(first + k) * rowSize,
+                         batch[k] * rowSize, rowSize);
+            }
+        }
     }
 
     template <typename T>
-    void shuffle(ShareVec<T> & inOut, const size_t rowSize,
-                 const std::vector<size_t> & perm, bool dir)
+    static void swapRows(ShareVec<T> & inOut, size_t a, size_t b,
+                         const size_t rowSize)
     {
-        ShareVec<T> copy (inOut.size());
-        copy.assign(inOut);
-        for (size_t i = 0; i < perm.size(); ++i) {
-            size_t to, from;
-            if (dir) {
-                to = perm[i] * rowSize;
-                from = i * rowSize;
-            } else {
-                to = i * rowSize;
-                from = perm[i] * rowSize;
-            }
-            for (size_t j = 0u; j < rowSize; ++j)
-                inOut[to + j] = copy[from + j];
+        if (a == b)
+            return;
+
+        // Copy through values, the bit vector elements are proxies:
+        for (size_t j = 0u; j < rowSize; ++j) {
+            const typename ValueTraits<T>::share_type x = inOut[a + j];
+            const typename ValueTraits<T>::share_type y = inOut[b + j];
+            inOut[a + j] = y;
+            inOut[b + j] = x;
         }
     }
 
@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef MOD_SHARED3P_EMU_PROTOCOLS_NATIVEFLOAT_H
+#define MOD_SHARED3P_EMU_PROTOCOLS_NATIVEFLOAT_H
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <LogHard/Logger.h>
+#include <sstream>
+#include "../Shared3pPDPI.h"
+#include "../Shared3pValueTraits.h"
+#include "SoftFloatUtility.h"
+
+/*
+ * Native results are only bit-exact when every operation is rounded once to
+ * its IEEE 754 format, which excludes for example the x87 FPU.
+ */
+#if FLT_EVAL_METHOD == 0
+#define MOD_SHARED3P_EMU_NATIVE_FLOAT 1
+#else
+#define MOD_SHARED3P_EMU_NATIVE_FLOAT 0
+#endif
+
+namespace sharemind {
+
+namespace {
+
+template <typename S> struct NativeFloatType;
+template <> struct NativeFloatType<sf_float32> { using type = float; };
+template <> struct NativeFloatType<sf_float64> { using type = double; };
+
+inline bool isFloatNaN(sf_float32 a) noexcept
+{ return (a & 0x7fffffffu) > 0x7f800000u; }
+
+inline bool isFloatNaN(sf_float64 a) noexcept
+{ return (a & 0x7fffffffffffffffu) > 0x7ff0000000000000u; }
+
+struct NativeFloatAdd {
+    static const char * name() noexcept { return "add"; }
+    template <typename S> static bool defined(S, S) noexcept { return true; }
+    template <typename S> static S soft(S a, S b)
+    { return sf_float_add(a, b).result; }
+    template <typename F> static F native(F a, F b) noexcept { return a + b; }
+};
+
+struct NativeFloatSub {
+    static const char * name() noexcept { return "sub"; }
+    template <typename S> static bool defined(S, S) noexcept { return true; }
+    template <typename S> static S soft(S a, S b)
+    { return sf_float_sub(a, b).result; }
+    template <typename F> static F native(F a, F b) noexcept { return a - b; }
+};
+
+struct NativeFloatMul {
+    static const char * name() noexcept { return "mul"; }
+    template <typename S> static bool defined(S, S) noexcept { return true; }
+    template <typename S> static S soft(S a, S b)
+    { return sf_float_mul(a, b).result; }
+    template <typename F> static F native(F a, F b) noexcept { return a * b; }
+};
+
+/** Results of division by a positive zero are left untouched. */
+struct NativeFloatDiv {
+    static const char * name() noexcept { return "div"; }
+    template <typename S> static bool defined(S, S b) noexcept
+    { return b != 0u; }
+    template <typename S> static S soft(S a, S b)
+    { return sf_float_div(a, b).result; }
+    template <typename F> static F native(F a, F b) noexcept { return a / b; }
+};
+
+struct NativeFloatInv {
+    static const char * name() noexcept { return "inv"; }
+    template <typename S> static S soft(S a)
+    { return sf_float_inv(a).result; }
+    template <typename F> static F native(F a) noexcept { return F(1) / a; }
+};
+
+struct NativeFloatSqrt {
+    static const char * name() noexcept { return "sqrt"; }
+    template <typename S> static S soft(S a)
+    { return sf_float_sqrt(a).result; }
+    template <typename F> static F native(F a) noexcept { return std::sqrt(a); }
+};
+
+} /* namespace { */
+
+/**
+ * \brief Computes correctly rounded floating point operations on the FPU of
+ *        the host if the protection domain is configured to do so.
+ *
+ * The operations are computed in blocks on local arrays so that the compiler
+ * can vectorize them. NaN results are recomputed in LibSoftfloat because NaN
+ * payloads differ between implementations. In verification mode, every
+ * floatVerifyInterval()-th result is also recomputed in LibSoftfloat, the
+ * LibSoftfloat result is kept and mismatches are logged.
+ */
+class __attribute__ ((visibility("internal"))) NativeFloat {
+
+private: /* Constants: */
+
+    static constexpr size_t BLOCK_SIZE = 256u;
+
+public: /* Methods: */
+
+    NativeFloat(Shared3pPDPI & pdpi)
+        : m_pdpi(pdpi)
+        , m_arithmetic(MOD_SHARED3P_EMU_NATIVE_FLOAT &&
+                       std::numeric_limits<float>::is_iec559 &&
+                       std::numeric_limits<double>::is_iec559
+                       ? pdpi.floatArithmetic()
+                       : FloatArithmetic::SoftFloat)
+        , m_verifyInterval(pdpi.floatVerifyInterval())
+    {}
+
+    inline bool enabled() const noexcept
+    { return m_arithmetic != FloatArithmetic::SoftFloat; }
+
+    /** Computes result[i] = Op(param1[i], param2[i]) for i < result.size(). */
+    template <typename Op, typename T, typename P1, typename P2>
+    void apply(const P1 & param1, const P2 & param2, ShareVec<T> & result) {
+        using S = typename ValueTraits<T>::share_type;
+        using F = typename NativeFloatType<S>::type;
+        static_assert(sizeof(S) == sizeof(F), "Unexpected float size!");
+
+        S a[BLOCK_SIZE], b[BLOCK_SIZE], z[BLOCK_SIZE];
+        F x[BLOCK_SIZE], y[BLOCK_SIZE], r[BLOCK_SIZE];
+        const size_t size = result.size();
+
+        for (size_t begin = 0u; begin < size; begin += BLOCK_SIZE) {
+            const size_t n = std::min(size - begin, size_t(BLOCK_SIZE));
+
+            for (size_t k = 0u; k < n; ++k) {
+                a[k] = param1[begin + k];
+                b[k] = param2[begin + k];
+            }
+
+            memcpy(x, a, n * sizeof(S));
+            memcpy(y, b, n * sizeof(S));
+            for (size_t k = 0u; k < n; ++k)
+                r[k] = Op::native(x[k], y[k]);
+            memcpy(z, r, n * sizeof(S));
+
+            for (size_t k = 0u; k < n; ++k) {
+                if (isFloatNaN(z[k]))
+                    z[k] = Op::soft(a[k], b[k]);
+            }
+
+            if (m_arithmetic == FloatArithmetic::Verify)
+                verify<Op>(begin, n, z, a, b);
+
+            for (size_t k = 0u; k < n; ++k) {
+                if (Op::defined(a[k], b[k]))
+                    result[begin + k] = z[k];
+            }
+        }
+    }
+
+    /** Computes result[i] = Op(param[i]) for i < result.size(). */
+    template <typename Op, typename T>
+    void apply(const ShareVec<T> & param, ShareVec<T> & result) {
+        using S = typename ValueTraits<T>::share_type;
+        using F = typename NativeFloatType<S>::type;
+        static_assert(sizeof(S) == sizeof(F), "Unexpected float size!");
+
+        S a[BLOCK_SIZE], z[BLOCK_SIZE];
+        F x[BLOCK_SIZE], r[BLOCK_SIZE];
+        const size_t size = result.size();
+
+        for (size_t begin = 0u; begin < size; begin += BLOCK_SIZE) {
+            const size_t n = std::min(size - begin, size_t(BLOCK_SIZE));
+
+            for (size_t k = 0u; k < n; ++k)
+                a[k] = param[begin + k];
+
+            memcpy(x, a, n * sizeof(S));
+            for (size_t k = 0u; k < n; ++k)
+                r[k] = Op::native(x[k]);
+            memcpy(z, r, n * sizeof(S));
+
+            for (size_t k = 0u; k < n; ++k) {
+                if (isFloatNaN(z[k]))
+                    z[k] = Op::soft(a[k]);
+            }
+
+            if (m_arithmetic == FloatArithmetic::Verify)
+                verify<Op>(begin, n, z, a);
+
+            for (size_t k = 0u; k < n; ++k)
+                result[begin + k] = z[k];
+        }
+    }
+
+private: /* Methods: */
+
+    template <typename Op, typename S, typename ... Ps>
+    void verify(size_t begin, size_t n, S * z, const Ps * ... params) {
+        size_t checks = 0u;
+        size_t mismatches = 0u;
+        size_t first = 0u;
+        S native = 0u;
+
+        // Sample the elements whose index is a multiple of the interval:
+        for (size_t k = (m_verifyInterval - begin % m_verifyInterval)
+                        % m_verifyInterval;
+             k < n;
+             k += m_verifyInterval)
+        {
+            const S soft = Op::soft(params[k]...);
+            ++checks;
+            if (soft != z[k]) {
+                if (mismatches++ == 0u) {
+                    first = k;
+                    native = z[k];
+                }
+                z[k] = soft;
+            }
+        }
+
+        if (m_pdpi.countFloatVerification(checks, mismatches)) {
+            try {
+                std::ostringstream oss;
+                oss << std::hex << std::showbase << "Native floating point "
+                    << Op::name() << " of";
+                for (const S param : { params[first]... })
+                    oss << ' ' << param;
+                oss << " gave " << native << " instead of " << z[first]
+                    << " in protection domain '" << m_pdpi.pdName() << "'.";
+                m_pdpi.logger().warning() << oss.str();
+            } catch (...) {}
+        }
+    }
+
+private: /* Fields: */
+
+    Shared3pPDPI & m_pdpi;
+    const FloatArithmetic m_arithmetic;
+    const size_t m_verifyInterval;
+
+}; /* class NativeFloat { */
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_PROTOCOLS_NATIVEFLOAT_H */
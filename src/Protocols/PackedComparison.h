@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef MOD_SHARED3P_EMU_PROTOCOLS_PACKEDCOMPARISON_H
+#define MOD_SHARED3P_EMU_PROTOCOLS_PACKEDCOMPARISON_H
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include "../Shared3pValueTraits.h"
+#include "../Shared3pVector.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+namespace sharemind {
+
+/**
+ * \brief Compares integer vectors 64 elements at a time and returns the
+ *        results as the bits of a 64-bit mask.
+ *
+ * Only "equal" and "less" are computed directly, the other comparisons are
+ * their complements or have their operands swapped. With AVX2 the lanes are
+ * compared with a single instruction each and the lane masks are gathered
+ * with movemask. Unsigned lanes are compared as signed after flipping their
+ * sign bits.
+ */
+template <typename S>
+class __attribute__ ((visibility("internal"))) PackedComparison {
+
+    static_assert(std::is_integral<S>::value, "");
+
+public: /* Types: */
+
+    static constexpr size_t BLOCK_SIZE = 64u;
+
+public: /* Methods: */
+
+    static uint64_t equal(const S * a, const S * b) noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        if (haveAvx2())
+            return equalAvx2(a, b);
+#endif
+        uint64_t mask = 0u;
+        for (size_t i = 0u; i < BLOCK_SIZE; ++i)
+            mask |= uint64_t(a[i] == b[i]) << i;
+        return mask;
+    }
+
+    static uint64_t less(const S * a, const S * b) noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        if (haveAvx2())
+            return lessAvx2(a, b);
+#endif
+        uint64_t mask = 0u;
+        for (size_t i = 0u; i < BLOCK_SIZE; ++i)
+            mask |= uint64_t(a[i] < b[i]) << i;
+        return mask;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+private: /* Types: */
+
+    static constexpr size_t LANES = 32u / sizeof(S);
+
+private: /* Methods: */
+
+    static bool haveAvx2() noexcept {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    __attribute__ ((target("avx2")))
+    static __m256i load(const S * p) noexcept
+    { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+
+    __attribute__ ((target("avx2")))
+    static __m256i cmpeq(__m256i x, __m256i y) noexcept {
+        switch (sizeof(S)) {
+        case 1u: return _mm256_cmpeq_epi8(x, y);
+        case 2u: return _mm256_cmpeq_epi16(x, y);
+        case 4u: return _mm256_cmpeq_epi32(x, y);
+        default: return _mm256_cmpeq_epi64(x, y);
+        }
+    }
+
+    __attribute__ ((target("avx2")))
+    static __m256i cmpgt(__m256i x, __m256i y) noexcept {
+        switch (sizeof(S)) {
+        case 1u: return _mm256_cmpgt_epi8(x, y);
+        case 2u: return _mm256_cmpgt_epi16(x, y);
+        case 4u: return _mm256_cmpgt_epi32(x, y);
+        default: return _mm256_cmpgt_epi64(x, y);
+        }
+    }
+
+    /* Flips the sign bits of unsigned lanes. */
+    __attribute__ ((target("avx2")))
+    static __m256i toSigned(__m256i x) noexcept {
+        if (std::is_signed<S>::value)
+            return x;
+
+        switch (sizeof(S)) {
+        case 1u: return _mm256_xor_si256(x, _mm256_set1_epi8(INT8_MIN));
+        case 2u: return _mm256_xor_si256(x, _mm256_set1_epi16(INT16_MIN));
+        case 4u: return _mm256_xor_si256(x, _mm256_set1_epi32(INT32_MIN));
+        default: return _mm256_xor_si256(x, _mm256_set1_epi64x(INT64_MIN));
+        }
+    }
+
+    /* The lane masks of two comparison results, 2 * LANES bits. */
+    __attribute__ ((target("avx2")))
+    static uint64_t movemask2(__m256i c0, __m256i c1) noexcept {
+        switch (sizeof(S)) {
+        case 1u:
+            return uint64_t(uint32_t(_mm256_movemask_epi8(c0)))
+                 | uint64_t(uint32_t(_mm256_movemask_epi8(c1))) << 32u;
+        case 2u:
+            // packs interleaves the 128-bit halves of c0 and c1:
+            return uint32_t(_mm256_movemask_epi8(_mm256_permute4x64_epi64(
+                        _mm256_packs_epi16(c0, c1), 0xd8)));
+        case 4u:
+            return uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(c0)))
+                 | uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(c1))) << 8u;
+        default:
+            return uint64_t(_mm256_movemask_pd(_mm256_castsi256_pd(c0)))
+                 | uint64_t(_mm256_movemask_pd(_mm256_castsi256_pd(c1))) << 4u;
+        }
+    }
+
+    __attribute__ ((target("avx2")))
+    static uint64_t equalAvx2(const S * a, const S * b) noexcept {
+        uint64_t mask = 0u;
+        for (size_t i = 0u; i < BLOCK_SIZE; i += 2u * LANES) {
+            const __m256i c0 = cmpeq(load(a + i), load(b + i));
+            const __m256i c1 = cmpeq(load(a + i + LANES), load(b + i + LANES));
+            mask |= movemask2(c0, c1) << i;
+        }
+        return mask;
+    }
+
+    __attribute__ ((target("avx2")))
+    static uint64_t lessAvx2(const S * a, const S * b) noexcept {
+        uint64_t mask = 0u;
+        for (size_t i = 0u; i < BLOCK_SIZE; i += 2u * LANES) {
+            const __m256i c0 = cmpgt(toSigned(load(b + i)),
+                                     toSigned(load(a + i)));
+            const __m256i c1 = cmpgt(toSigned(load(b + i + LANES)),
+                                     toSigned(load(a + i + LANES)));
+            mask |= movemask2(c0, c1) << i;
+        }
+        return mask;
+    }
+
+#endif
+
+}; /* class PackedComparison { */
+
+/**
+ * \brief Sets result[i] = cmp(a, b)[i] where cmp maps blocks of
+ *        PackedComparison<S>::BLOCK_SIZE shares to a bit mask.
+ */
+template <typename T, typename Compare>
+void comparePacked(const ShareVec<T> & param1,
+                   const ShareVec<T> & param2,
+                   ShareVec<s3p_bool_t> & result,
+                   Compare cmp)
+{
+    using S = typename ValueTraits<T>::share_type;
+    constexpr size_t BLOCK_SIZE = PackedComparison<S>::BLOCK_SIZE;
+    static_assert(ShareVec<s3p_bool_t>::blockBits == BLOCK_SIZE,
+                  "Unexpected block size of bit vectors!");
+
+    S a[BLOCK_SIZE] = {}, b[BLOCK_SIZE] = {};
+    const size_t size = result.size();
+
+    result.generateBlocks([&](size_t block) {
+        const size_t begin = block * BLOCK_SIZE;
+        const size_t n = std::min(size - begin, BLOCK_SIZE);
+        for (size_t k = 0u; k < n; ++k) {
+            a[k] = param1[begin + k];
+            b[k] = param2[begin + k];
+        }
+        return cmp(a, b);
+    });
+}
+
+struct __attribute__ ((visibility("internal"))) PackedEqual {
+    template <typename S>
+    uint64_t operator()(const S * a, const S * b) const noexcept
+    { return PackedComparison<S>::equal(a, b); }
+};
+
+struct __attribute__ ((visibility("internal"))) PackedLess {
+    template <typename S>
+    uint64_t operator()(const S * a, const S * b) const noexcept
+    { return PackedComparison<S>::less(a, b); }
+};
+
+struct __attribute__ ((visibility("internal"))) PackedLessOrEqual {
+    template <typename S>
+    uint64_t operator()(const S * a, const S * b) const noexcept
+    { return ~PackedComparison<S>::less(b, a); }
+};
+
+struct __attribute__ ((visibility("internal"))) PackedGreater {
+    template <typename S>
+    uint64_t operator()(const S * a, const S * b) const noexcept
+    { return PackedComparison<S>::less(b, a); }
+};
+
+struct __attribute__ ((visibility("internal"))) PackedGreaterOrEqual {
+    template <typename S>
+    uint64_t operator()(const S * a, const S * b) const noexcept
+    { return ~PackedComparison<S>::less(a, b); }
+};
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_PROTOCOLS_PACKEDCOMPARISON_H */
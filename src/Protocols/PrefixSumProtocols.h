@@ -10,7 +10,10 @@
 #ifndef MOD_SHARED3P_EMU_PREFIXSUMSYSCALLS_H
 #define MOD_SHARED3P_EMU_PREFIXSUMSYSCALLS_H
 
+#include <algorithm>
+#include <vector>
 #include "../SecretSharing.h"
+#include "../Shared3pPDPI.h"
 #include "../Shared3pValueTraits.h"
 #include "../Shared3pVector.h"
 
@@ -18,87 +21,225 @@ namespace sharemind {
 
 namespace {
 
+/** Parallel scans split the vector into chunks of this many elements. */
+constexpr size_t PREFIX_SUM_CHUNK = 1u << 16u;
+
+/** Segments are split between the threads in chunks of about this size. */
+constexpr size_t PREFIX_SUM_SEGMENT_GRAIN = 1u << 14u;
+
+template <typename T>
+inline typename ValueTraits<T>::share_type addShares(
+        const typename ValueTraits<T>::share_type& src1,
+        const typename ValueTraits<T>::share_type& src2)
+{
+    return SecretSharing::combine(src1, src2, typename ValueTraits<T>::value_category{});
+}
+
+template <typename T>
+inline typename ValueTraits<T>::share_type subShares(
+        const typename ValueTraits<T>::share_type& src1,
+        const typename ValueTraits<T>::share_type& src2)
+{
+    return addShares<T>(src1, SecretSharing::inverse(
+                            src2, typename ValueTraits<T>::value_category{}));
+}
+
+/** Prefix sum of in[begin, end) into out, starting from the given sum. */
 template <typename T>
-void addShares(typename ShareVec<T>::reference dest,
-               const typename ValueTraits<T>::share_type& src1,
-               const typename ValueTraits<T>::share_type& src2)
+inline void prefixSumRange(const ShareVec<T>& in, ShareVec<T>& out,
+                           size_t begin, size_t end,
+                           typename ValueTraits<T>::share_type sum)
 {
-    dest = SecretSharing::combine(src1, src2, typename ValueTraits<T>::value_category{});
+    for (size_t i = begin; i < end; ++i) {
+        sum = addShares<T>(in[i], sum);
+        out[i] = sum;
+    }
 }
 
+/**
+ * Inverse prefix sum of in[begin, end) into out, prev being in[begin - 1].
+ * Goes backwards, so in and out may be the same vector.
+ */
 template <typename T>
-void subShares(typename ShareVec<T>::reference dest,
-               const typename ValueTraits<T>::share_type& src1,
-               const typename ValueTraits<T>::share_type& src2)
+inline void invPrefixSumRange(const ShareVec<T>& in, ShareVec<T>& out,
+                              size_t begin, size_t end,
+                              const typename ValueTraits<T>::share_type& prev)
 {
-    addShares<T>(dest, src1, SecretSharing::inverse(
-                     src2, typename ValueTraits<T>::value_category{}));
+    for (size_t i = end - 1u; i > begin; --i)
+        out[i] = subShares<T>(in[i], in[i - 1u]);
+    out[begin] = subShares<T>(in[begin], prev);
 }
 
+/**
+ * Scans of long vectors are done in two passes over chunks. The first pass
+ * sums every chunk, the second scans every chunk starting from the sum of
+ * the chunks before it. The inverse scan only needs the element before every
+ * chunk, which is saved before the chunks are overwritten.
+ */
 template <typename T>
-inline bool freePrefixSum(const ShareVec<T>& in, ShareVec<T>& out) {
+inline bool freePrefixSum(Shared3pPDPI& pdpi, const ShareVec<T>& in,
+                          ShareVec<T>& out)
+{
+    typedef typename ValueTraits<T>::share_type share_type;
+
     if (in.size() != out.size()) {
         return false;
     }
 
-    if (out.size() > 0) {
-        out[0] = in[0];
+    const size_t size = out.size();
+    if (size < pdpi.parallelThreshold() || size <= PREFIX_SUM_CHUNK) {
+        prefixSumRange(in, out, 0u, size, share_type(0));
+        return true;
     }
 
-    for (size_t i = 1; i < out.size(); ++i) {
-        addShares<T>(out[i], in[i], out[i - 1]);
+    const size_t chunks = (size + PREFIX_SUM_CHUNK - 1u) / PREFIX_SUM_CHUNK;
+    std::vector<share_type> sums(chunks);
+    pdpi.threadPool().parallelFor(chunks, 1u,
+        [&in, &sums, size](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                share_type sum(0);
+                const size_t last = std::min(size, (c + 1u) * PREFIX_SUM_CHUNK);
+                for (size_t i = c * PREFIX_SUM_CHUNK; i < last; ++i)
+                    sum = addShares<T>(in[i], sum);
+                sums[c] = sum;
+            }
+        });
+
+    // Exclusive scan of the chunk sums:
+    share_type sum(0);
+    for (share_type & s : sums) {
+        const share_type chunkSum = s;
+        s = sum;
+        sum = addShares<T>(chunkSum, sum);
     }
 
+    pdpi.threadPool().parallelFor(chunks, 1u,
+        [&in, &out, &sums, size](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c)
+                prefixSumRange(in, out, c * PREFIX_SUM_CHUNK,
+                               std::min(size, (c + 1u) * PREFIX_SUM_CHUNK),
+                               sums[c]);
+        });
+
     return true;
 }
 
 template <typename T>
-inline bool freeInvPrefixSum(const ShareVec<T> & in, ShareVec<T>& out) {
+inline bool freeInvPrefixSum(Shared3pPDPI& pdpi, const ShareVec<T>& in,
+                             ShareVec<T>& out)
+{
+    typedef typename ValueTraits<T>::share_type share_type;
+
     if (in.size() != out.size()) {
         return false;
     }
 
-    if (out.size() > 0) {
-        out[0] = in[0];
+    const size_t size = out.size();
+    if (size == 0u) {
+        return true;
     }
 
-    for (size_t i = out.size() - 1; i > 0; --i) {
-        subShares<T>(out[i], in[i], in[i - 1]);
+    if (size < pdpi.parallelThreshold() || size <= PREFIX_SUM_CHUNK) {
+        invPrefixSumRange(in, out, 0u, size, share_type(0));
+        return true;
     }
 
+    const size_t chunks = (size + PREFIX_SUM_CHUNK - 1u) / PREFIX_SUM_CHUNK;
+    std::vector<share_type> prevs(chunks, share_type(0));
+    for (size_t c = 1u; c < chunks; ++c)
+        prevs[c] = in[c * PREFIX_SUM_CHUNK - 1u];
+
+    pdpi.threadPool().parallelFor(chunks, 1u,
+        [&in, &out, &prevs, size](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c)
+                invPrefixSumRange(in, out, c * PREFIX_SUM_CHUNK,
+                                  std::min(size, (c + 1u) * PREFIX_SUM_CHUNK),
+                                  prevs[c]);
+        });
+
     return true;
 }
 
+/**
+ * In place (inverse) prefix sum of vec[start + j * step] for j < count.
+ * \pre the indexes are in range.
+ */
+template <typename T>
+inline void stridedPrefixSum(ShareVec<T>& vec, size_t start, size_t step,
+                             size_t count, bool direction)
+{
+    typedef typename ValueTraits<T>::share_type share_type;
+
+    if (count <= 1u) {
+        return;
+    }
+
+    if (step == 0u) {
+        // Every partial sum is written to the same element, the last wins:
+        const share_type x = vec[start];
+        if (direction) {
+            share_type sum = x;
+            for (size_t j = 1u; j < count; ++j)
+                sum = addShares<T>(x, sum);
+            vec[start] = sum;
+        } else {
+            vec[start] = subShares<T>(x, x);
+        }
+        return;
+    }
+
+    if (direction) {
+        for (size_t j = 1u, idx = start + step; j < count; ++j, idx += step)
+            vec[idx] = addShares<T>(vec[idx], vec[idx - step]);
+    } else {
+        for (size_t idx = start + (count - 1u) * step; idx > start; idx -= step)
+            vec[idx] = subShares<T>(vec[idx], vec[idx - step]);
+    }
+}
+
 } /* namespace { */
 
 class __attribute__ ((visibility("internal"))) PrefixSumProtocol {
 public: /* Methods: */
 
-    PrefixSumProtocol(Shared3pPDPI& pdpi) { (void) pdpi; }
+    PrefixSumProtocol(Shared3pPDPI& pdpi) : m_pdpi(pdpi) {}
 
     template <typename T>
     bool invoke(const ShareVec<T>& in, ShareVec<T>& out) {
-        return freePrefixSum(in, out);
+        return freePrefixSum(m_pdpi, in, out);
     }
 
+private: /* Fields: */
+
+    Shared3pPDPI& m_pdpi;
+
 }; /* class PrefixSumProtocol */
 
 class __attribute__ ((visibility("internal"))) InvPrefixSumProtocol {
 public: /* Methods: */
 
-    InvPrefixSumProtocol(Shared3pPDPI& pdpi) { (void) pdpi; }
+    InvPrefixSumProtocol(Shared3pPDPI& pdpi) : m_pdpi(pdpi) {}
 
     template <typename T>
     bool invoke(const ShareVec<T>& in, ShareVec<T>& out) {
-        return freeInvPrefixSum(in, out);
+        return freeInvPrefixSum(m_pdpi, in, out);
     }
 
+private: /* Fields: */
+
+    Shared3pPDPI& m_pdpi;
+
 }; /* class PrefixSumProtocol */
 
+/**
+ * Scans the strided segments of a vector in place. Segments are scanned in
+ * parallel if there is enough work and no element is in two segments,
+ * overlapping segments are scanned one after another in the given order.
+ */
 class __attribute__ ((visibility("internal"))) MatPrefixSumProtocol {
 public: /* Methods: */
 
-    MatPrefixSumProtocol(Shared3pPDPI& pdpi) { (void) pdpi; }
+    MatPrefixSumProtocol(Shared3pPDPI& pdpi) : m_pdpi(pdpi) {}
 
     template <typename T>
     bool invoke(ShareVec<T>& vec,
@@ -113,36 +254,73 @@ public: /* Methods: */
             return false;
         }
 
+        // Check all segments before changing any of them:
+        size_t total = 0u;
         for (size_t i = 0; i < start.size(); ++i) {
-            ShareVec<T> w(count[i]);
-            ShareVec<T> out(count[i]);
-
-            for (size_t j = 0; j < count[i]; ++j) {
-                size_t idx = start[i] + j * step[i];
-                if (idx >= vec.size()) {
-                    return false;
-                }
-                w[j] = vec[idx];
+            if (count[i] == 0u) {
+                continue;
             }
 
-            if (direction) {
-                if (!freePrefixSum(w, out)) {
-                    return false;
-                }
-            } else {
-                if (!freeInvPrefixSum(w, out)) {
-                    return false;
-                }
+            // The last index start + (count - 1) * step must be in range:
+            if (start[i] >= vec.size() ||
+                (step[i] != 0u &&
+                 size_t(count[i] - 1u) > (vec.size() - 1u - start[i]) / step[i]))
+            {
+                return false;
             }
+            total += count[i];
+        }
 
-            for (size_t j = 0; j < count[i]; ++j) {
-                vec[start[i] + j * step[i]] = out[j];
+        const size_t segments = start.size();
+        if (segments > 1u && total >= m_pdpi.parallelThreshold()
+            && disjoint(vec.size(), start, step, count))
+        {
+            const size_t grain = std::max<size_t>(
+                    1u, PREFIX_SUM_SEGMENT_GRAIN * segments / total);
+            m_pdpi.threadPool().parallelFor(segments, grain,
+                [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i)
+                        stridedPrefixSum(vec, start[i], step[i], count[i],
+                                         direction);
+                });
+        } else {
+            for (size_t i = 0; i < segments; ++i) {
+                stridedPrefixSum(vec, start[i], step[i], count[i], direction);
             }
         }
 
         return true;
     }
 
+private: /* Methods: */
+
+    /** \pre the indexes of the segments are in range. */
+    static bool disjoint(size_t size,
+                         const ImmutableVmVec<s3p_uint32_t>& start,
+                         const ImmutableVmVec<s3p_uint32_t>& step,
+                         const ImmutableVmVec<s3p_uint32_t>& count)
+    {
+        std::vector<bool> used(size);
+        for (size_t i = 0; i < start.size(); ++i) {
+            if (count[i] > 1u && step[i] == 0u) {
+                return false;
+            }
+
+            size_t idx = start[i];
+            for (size_t j = 0; j < count[i]; ++j, idx += step[i]) {
+                if (used[idx]) {
+                    return false;
+                }
+                used[idx] = true;
+            }
+        }
+        return true;
+    }
+
+private: /* Fields: */
+
+    Shared3pPDPI& m_pdpi;
+
 }; /* class PrefixSumProtocol */
 
 } /* namespace sharemind { */
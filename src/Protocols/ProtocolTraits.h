@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef MOD_SHARED3P_EMU_PROTOCOLS_PROTOCOLTRAITS_H
+#define MOD_SHARED3P_EMU_PROTOCOLS_PROTOCOLTRAITS_H
+
+#include <sharemind/libemulator_protocols/Ternary.h>
+#include <type_traits>
+#include "Binary.h"
+#include "FixedPoint.h"
+#include "Ternary.h"
+#include "Unary.h"
+
+
+namespace sharemind {
+
+/**
+ * \brief Marks protocols whose i-th output depends only on the i-th inputs.
+ *
+ * Such protocols may be run on disjoint slices of their vectors in parallel
+ * without changing the result.
+ */
+template <typename Protocol>
+struct is_elementwise_protocol: std::false_type {};
+
+#define MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(...) \
+    template <> \
+    struct is_elementwise_protocol<__VA_ARGS__>: std::true_type {}
+
+/* Binary: */
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(AdditionProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(BitwiseAndProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(BitwiseOrProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(BitwiseXorProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(DivisionProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(EqualityProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(GreaterThanProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(GreaterThanOrEqualProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(LeftShiftProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(LessThanProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(LessThanOrEqualProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(MaximumProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(MinimumProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(MultiplicationProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(RemainderProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(RightShiftProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(SubtractionProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(SubtractSquareProtocol);
+
+/* Unary: */
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(AbsoluteValueProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(BitwiseInvProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(ConversionProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FloatCeilingProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FloatErrorFunctionProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FloatFloorProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FloatInverseProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FloatIsNegligibleProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FloatNaturalLogarithmProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FloatPowerOfEProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FloatSineProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FloatSquareRootProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(MostSignificantNonZeroBitProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(NegProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(NotProtocol<Shared3pPDPI>);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(SignProtocol<Shared3pPDPI>);
+
+/* Fixed point: */
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FixInverseProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FixMultiplicationProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FixSquareRootProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FixToFloatProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FloatToFixProtocol);
+
+/* Ternary: */
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(FusedMultiplyAddProtocol);
+MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL(ObliviousChoiceProtocol<Shared3pPDPI>);
+
+#undef MOD_SHARED3P_EMU_ELEMENTWISE_PROTOCOL
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_PROTOCOLS_PROTOCOLTRAITS_H */
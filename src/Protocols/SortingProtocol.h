@@ -21,75 +21,130 @@
 #define MOD_SHARED3P_EMU_PROTOCOLS_SORTINGPROTOCOL_H
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <sharemind/VmVector.h>
-#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include "../Shared3pPDPI.h"
 #include "../Shared3pValueTraits.h"
 #include "../Shared3pVector.h"
-#include "SoftFloatUtility.h"
 
 namespace sharemind {
 
 namespace {
 
-template<typename T>
-typename std::enable_if<! is_float_value_tag<T>::value, bool>::type
-lt(const typename sharemind::ValueTraits<T>::share_type & a,
-   const typename sharemind::ValueTraits<T>::share_type & b)
-{
-    return a < b;
-}
+template <size_t N> struct RadixKeyType;
+template <> struct RadixKeyType<1u> { using type = uint8_t; };
+template <> struct RadixKeyType<2u> { using type = uint16_t; };
+template <> struct RadixKeyType<4u> { using type = uint32_t; };
+template <> struct RadixKeyType<8u> { using type = uint64_t; };
 
-template<typename T>
-typename std::enable_if<is_float_value_tag<T>::value, bool>::type
-lt(const typename sharemind::ValueTraits<T>::share_type & a,
-   const typename sharemind::ValueTraits<T>::share_type & b)
-{
-    return sf_float_lt(a, b).result;
+/**
+ * Unsigned integer whose natural order matches the order of the values of
+ * type T.
+ */
+template <typename T>
+using RadixKey =
+    typename RadixKeyType<
+        sizeof(typename sharemind::ValueTraits<T>::share_type)>::type;
+
+template <typename K>
+constexpr K radixSignBit() { return K(K(1u) << (8u * sizeof(K) - 1u)); }
+
+template <typename T>
+typename std::enable_if<is_float_value_tag<T>::value, RadixKey<T> >::type
+radixKey(const typename sharemind::ValueTraits<T>::share_type & value) {
+    using K = RadixKey<T>;
+    K bits;
+    memcpy(&bits, &value, sizeof(K));
+    // -0 and +0 are equal:
+    if (bits == radixSignBit<K>())
+        bits = 0u;
+    return (bits & radixSignBit<K>()) ? K(~bits) : K(bits | radixSignBit<K>());
 }
 
-template<typename T>
-typename std::enable_if<! is_float_value_tag<T>::value, bool>::type
-eq(const typename sharemind::ValueTraits<T>::share_type & a,
-   const typename sharemind::ValueTraits<T>::share_type & b)
-{
-    return a == b;
+template <typename T>
+typename std::enable_if<is_signed_value_tag<T>::value, RadixKey<T> >::type
+radixKey(const typename sharemind::ValueTraits<T>::share_type & value) {
+    using K = RadixKey<T>;
+    return K(static_cast<K>(value) ^ radixSignBit<K>());
 }
 
-template<typename T>
-typename std::enable_if<is_float_value_tag<T>::value, bool>::type
-eq(const typename sharemind::ValueTraits<T>::share_type & a,
-   const typename sharemind::ValueTraits<T>::share_type & b)
-{
-    return sf_float_eq(a, b).result;
+template <typename T>
+typename std::enable_if<
+    ! is_float_value_tag<T>::value &&
+    ! is_signed_value_tag<T>::value
+, RadixKey<T> >::type
+radixKey(const typename sharemind::ValueTraits<T>::share_type & value) {
+    return static_cast<RadixKey<T> >(value);
 }
 
-template<typename T>
-using Triple =
-    std::tuple<typename sharemind::ValueTraits<T>::share_type,
-               typename sharemind::ValueTraits<sharemind::s3p_xor_uint64_t>::share_type,
-               uint64_t>;
-
-template<typename T>
-struct Compare {
-    Compare(bool ascending)
-        : m_ascending(ascending)
-        {}
-
-    bool operator()(const Triple<T>& atrip, const Triple<T>& btrip) {
-        using Value = typename sharemind::ValueTraits<T>::share_type;
-        using Idx = typename sharemind::ValueTraits<sharemind::s3p_xor_uint64_t>::share_type;
-        Value a = std::get<0>(atrip), b = std::get<0>(btrip);
-        Idx i = std::get<1>(atrip), j = std::get<1>(btrip);
-        if (m_ascending)
-            return lt<T>(a, b) || (eq<T>(a, b) && i < j);
-        else
-            return lt<T>(b, a) || (eq<T>(a, b) && i < j);
+template <typename K>
+struct RadixItem {
+    K key;
+    uint64_t index;
+    uint64_t pos;
+};
+
+/* Blocks shorter than this are sorted by comparison: */
+constexpr size_t RADIX_SORT_MIN_BLOCK_SIZE = 256u;
+
+/**
+ * Stable LSD radix sort of items[0..n) by (key, index). Digits on which all
+ * the items agree are skipped and the index digits are skipped altogether if
+ * the items are already ordered by index.
+ */
+template <typename K>
+void radixSort(RadixItem<K> * items, RadixItem<K> * buffer, size_t n) {
+    using Item = RadixItem<K>;
+    using Histogram = std::array<size_t, 256u>;
+    constexpr size_t keyDigits = sizeof(K);
+    constexpr size_t numDigits = keyDigits + sizeof(uint64_t);
+
+    auto digit = [](const Item & item, size_t d) -> uint8_t {
+        return d < sizeof(uint64_t)
+               ? uint8_t(item.index >> (8u * d))
+               : uint8_t(item.key >> (8u * (d - sizeof(uint64_t))));
+    };
+
+    const bool sortedByIndex =
+        std::is_sorted(items, items + n,
+                       [](const Item & a, const Item & b)
+                       { return a.index < b.index; });
+    const size_t firstDigit = sortedByIndex ? sizeof(uint64_t) : 0u;
+
+    std::vector<Histogram> histograms(numDigits);
+    for (Histogram & h : histograms)
+        h.fill(0u);
+    for (size_t i = 0u; i < n; ++i)
+        for (size_t d = firstDigit; d < numDigits; ++d)
+            ++histograms[d][digit(items[i], d)];
+
+    Item * src = items;
+    Item * dst = buffer;
+    for (size_t d = firstDigit; d < numDigits; ++d) {
+        Histogram & h = histograms[d];
+        if (h[digit(src[0u], d)] == n)
+            continue;
+
+        size_t offset = 0u;
+        for (size_t & count : h) {
+            const size_t c = count;
+            count = offset;
+            offset += c;
+        }
+
+        for (size_t i = 0u; i < n; ++i)
+            dst[h[digit(src[i], d)]++] = src[i];
+
+        std::swap(src, dst);
     }
 
-    const bool m_ascending;
-};
+    if (src != items)
+        std::copy(src, src + n, items);
+}
 
 } /* anonymous namespace */
 
@@ -150,21 +205,40 @@ private: /* Methods: */
         if (param.size() <= 1)
             return true;
 
-        std::vector<Triple<T>> vec(param.size());
+        using K = RadixKey<T>;
+        using Item = RadixItem<K>;
+
+        // Descending order is ascending order of the complemented keys, ties
+        // are still broken by ascending indices:
+        const K keyMask = ascending ? K(0u) : K(~K(0u));
+
+        std::vector<Item> vec(param.size());
         for (uint64_t i = 0; i < param.size(); ++i) {
-            vec[i] = std::make_tuple(param[i], indices[i], i);
+            vec[i].key = K(radixKey<T>(param[i]) ^ keyMask);
+            vec[i].index = indices[i];
+            vec[i].pos = i;
         }
 
-        Compare<T> cmp(ascending);
-
+        std::vector<Item> buffer;
         for (size_t i = 1; i < blocks.size(); ++i) {
-            std::sort(vec.begin() + blocks[i - 1],
-                      vec.begin() + blocks[i],
-                      cmp);
+            Item * const begin = vec.data() + blocks[i - 1];
+            const size_t n = blocks[i] - blocks[i - 1];
+
+            if (n < RADIX_SORT_MIN_BLOCK_SIZE) {
+                std::stable_sort(begin, begin + n,
+                    [](const Item & a, const Item & b) {
+                        return a.key < b.key ||
+                               (a.key == b.key && a.index < b.index);
+                    });
+            } else {
+                if (buffer.size() < n)
+                    buffer.resize(n);
+                radixSort(begin, buffer.data(), n);
+            }
         }
 
         for (size_t i = 0; i < param.size(); ++i) {
-            perm[i] = std::get<2>(vec[i]);
+            perm[i] = vec[i].pos;
         }
 
         return true;
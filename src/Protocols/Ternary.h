@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef MOD_SHARED3P_EMU_PROTOCOLS_TERNARY_H
+#define MOD_SHARED3P_EMU_PROTOCOLS_TERNARY_H
+
+#include <type_traits>
+#include "../Shared3pPDPI.h"
+#include "../Shared3pValueTraits.h"
+#include "../Shared3pVector.h"
+#include "SoftFloatUtility.h"
+
+namespace sharemind {
+
+/**
+ * \brief Computes param1 * param2 + param3 in a single pass.
+ *
+ * Floating point results are rounded after the multiplication and after the
+ * addition so that they equal those of separate mul and add calls.
+ */
+class __attribute__ ((visibility("internal"))) FusedMultiplyAddProtocol {
+public: /* Methods: */
+
+    FusedMultiplyAddProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+
+    template <typename T>
+    typename std::enable_if<is_integral_value_tag<T>::value, bool>::type
+    invoke(const ShareVec<T> & param1,
+           const ShareVec<T> & param2,
+           const ShareVec<T> & param3,
+           ShareVec<T> & result)
+    {
+        if (param1.size() != param2.size() ||
+                param1.size() != param3.size() ||
+                param1.size() != result.size())
+            return false;
+
+        using S = typename ValueTraits<T>::share_type;
+        using W = wrapping_type<S>;
+
+        for (size_t i = 0u; i < param1.size(); ++i)
+            result[i] = S(W(S(param1[i])) * W(S(param2[i])) + W(S(param3[i])));
+
+        return true;
+    }
+
+    template <typename T>
+    typename std::enable_if<is_float_value_tag<T>::value, bool>::type
+    invoke(const ShareVec<T> & param1,
+           const ShareVec<T> & param2,
+           const ShareVec<T> & param3,
+           ShareVec<T> & result)
+    {
+        if (param1.size() != param2.size() ||
+                param1.size() != param3.size() ||
+                param1.size() != result.size())
+            return false;
+
+        for (size_t i = 0u; i < param1.size(); ++i)
+            result[i] = sf_float_add(sf_float_mul(param1[i], param2[i]).result,
+                                     param3[i]).result;
+
+        return true;
+    }
+
+}; /* class FusedMultiplyAddProtocol { */
+
+} /* namespace sharemind { */
+
+#endif /* MOD_SHARED3P_EMU_PROTOCOLS_TERNARY_H */
@@ -25,6 +25,7 @@
 #include <type_traits>
 #include "../Shared3pValueTraits.h"
 #include "../Shared3pVector.h"
+#include "NativeFloat.h"
 
 
 namespace sharemind {
@@ -281,7 +282,7 @@ public: /* Methods: */
 class __attribute__ ((visibility("internal"))) FloatInverseProtocol {
 public: /* Methods: */
 
-    FloatInverseProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+    FloatInverseProtocol(Shared3pPDPI & pdpi) : m_nativeFloat(pdpi) {}
 
     template <typename T>
     typename std::enable_if<is_float_value_tag<T>::value, bool>::type
@@ -291,12 +292,21 @@ public: /* Methods: */
         if (param.size() != result.size())
             return false;
 
+        if (m_nativeFloat.enabled()) {
+            m_nativeFloat.apply<NativeFloatInv>(param, result);
+            return true;
+        }
+
         for (size_t i = 0u; i < param.size(); ++i)
             result[i] = sf_float_inv(param[i]).result;
 
         return true;
     }
 
+private: /* Fields: */
+
+    NativeFloat m_nativeFloat;
+
 }; /* class FloatInverseProtocol { */
 
 class __attribute__ ((visibility("internal"))) FloatIsNegligibleProtocol {
@@ -384,7 +394,7 @@ public: /* Methods: */
 class __attribute__ ((visibility("internal"))) FloatSquareRootProtocol {
 public: /* Methods: */
 
-    FloatSquareRootProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+    FloatSquareRootProtocol(Shared3pPDPI & pdpi) : m_nativeFloat(pdpi) {}
 
     template <typename T>
     typename std::enable_if<is_float_value_tag<T>::value, bool>::type
@@ -394,11 +404,21 @@ public: /* Methods: */
         if (param.size() != result.size())
             return false;
 
+        if (m_nativeFloat.enabled()) {
+            m_nativeFloat.apply<NativeFloatSqrt>(param, result);
+            return true;
+        }
+
         for (size_t i = 0u; i < param.size(); ++i)
             result[i] = sf_float_sqrt(param[i]).result;
 
         return true;
     }
+
+private: /* Fields: */
+
+    NativeFloat m_nativeFloat;
+
 }; /* class FloatSquareRootProtocol { */
 
 template <MinimumMaximumMode mode>
@@ -525,7 +545,8 @@ public: /* Methods: */
     template <typename T, typename U>
     typename std::enable_if<
         is_any_value_tag<T>::value &&
-        ! is_float_value_tag<T>::value
+        ! is_float_value_tag<T>::value &&
+        ! is_bool_value_tag<T>::value
     , bool>::type
     invoke(const ShareVec<T> & param,
            ShareVec<U> & result)
@@ -555,6 +576,28 @@ public: /* Methods: */
 
 }; /* class NegProtocol { */
 
+template <>
+class __attribute__ ((visibility("internal"))) NotProtocol<Shared3pPDPI> {
+public: /* Methods: */
+
+    NotProtocol(Shared3pPDPI & pdpi) { (void) pdpi; }
+
+    template <typename T>
+    typename std::enable_if<is_bool_value_tag<T>::value, bool>::type
+    invoke(const ShareVec<T> & param,
+           ShareVec<T> & result)
+    {
+        if (param.size() != result.size())
+            return false;
+
+        using B = ShareVec<s3p_bool_t>::block_type;
+        result.transformBlocks(param, [](B a) noexcept { return B(~a); });
+
+        return true;
+    }
+
+}; /* class NotProtocol { */
+
 template <>
 class __attribute__ ((visibility("internal"))) SumProtocol<Shared3pPDPI> {
 public: /* Methods: */
@@ -564,7 +607,8 @@ public: /* Methods: */
     template <typename T, typename U>
     typename std::enable_if<
         is_any_value_tag<T>::value &&
-        ! is_float_value_tag<T>::value
+        ! is_float_value_tag<T>::value &&
+        ! is_bool_value_tag<T>::value
     , bool>::type
     invoke(const ShareVec<T> & param,
            ShareVec<U> & result)
@@ -589,6 +633,26 @@ public: /* Methods: */
         return true;
     }
 
+    template <typename T, typename U>
+    typename std::enable_if<is_bool_value_tag<T>::value, bool>::type
+    invoke(const ShareVec<T> & param,
+           ShareVec<U> & result)
+    {
+        const size_t param_size = param.size ();
+        const size_t result_size = result.size ();
+        if (result_size == 0u)
+            return false;
+
+        if (param_size % result_size != 0u)
+            return false;
+
+        const size_t subarr_len = param_size / result_size;
+        for (size_t i = 0u; i < result_size; ++i)
+            result[i] = param.countOnes(i * subarr_len, (i + 1u) * subarr_len);
+
+        return true;
+    }
+
     template <typename T>
     typename std::enable_if<is_float_value_tag<T>::value, bool>::type
     invoke(const ShareVec<T> & param,
@@ -35,10 +35,67 @@ SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
 
 Shared3pConfiguration::Shared3pConfiguration(std::string const & filename)
     try
-    : m_modelEvaluatorConfiguration(
-          Configuration(filename).get<std::string>(
-              "ProtectionDomain.ModelEvaluatorConfiguration"))
-    {} catch (Configuration::Exception const &)
-    { std::throw_with_nested(ConfigurationException()); }
+{
+    Configuration const config(filename);
+    m_modelEvaluatorConfiguration =
+            config.get<std::string>(
+                "ProtectionDomain.ModelEvaluatorConfiguration");
+    m_numWorkerThreads =
+            config.get<std::size_t>("ProtectionDomain.NumWorkerThreads", 0u);
+    m_parallelThreshold =
+            config.get<std::size_t>("ProtectionDomain.ParallelThreshold",
+                                    16384u);
+    m_vectorPoolSize =
+            config.get<std::size_t>("ProtectionDomain.VectorPoolSize",
+                                    67108864u);
+
+    std::string const floatArithmetic =
+            config.get<std::string>("ProtectionDomain.FloatArithmetic",
+                                    "SoftFloat");
+    if (floatArithmetic == "SoftFloat") {
+        m_floatArithmetic = FloatArithmetic::SoftFloat;
+    } else if (floatArithmetic == "Native") {
+        m_floatArithmetic = FloatArithmetic::Native;
+    } else if (floatArithmetic == "Verify") {
+        m_floatArithmetic = FloatArithmetic::Verify;
+    } else {
+        throw ConfigurationException();
+    }
+
+    m_floatVerifyInterval =
+            config.get<std::size_t>("ProtectionDomain.FloatVerifyInterval",
+                                    64u);
+    if (m_floatVerifyInterval == 0u)
+        throw ConfigurationException();
+
+    std::string const syscallStatistics =
+            config.get<std::string>("ProtectionDomain.SyscallStatistics",
+                                    "None");
+    if (syscallStatistics == "None") {
+        m_syscallStatisticsFormat = SyscallStatistics::Format::None;
+    } else if (syscallStatistics == "JSON") {
+        m_syscallStatisticsFormat = SyscallStatistics::Format::Json;
+    } else if (syscallStatistics == "CSV") {
+        m_syscallStatisticsFormat = SyscallStatistics::Format::Csv;
+    } else {
+        throw ConfigurationException();
+    }
+
+    m_syscallStatisticsDirectory =
+            config.get<std::string>(
+                "ProtectionDomain.SyscallStatisticsDirectory",
+                "/tmp");
+    m_syscallStatisticsSampleInterval =
+            config.get<std::size_t>(
+                "ProtectionDomain.SyscallStatisticsSampleInterval",
+                16u);
+    if (m_syscallStatisticsSampleInterval == 0u)
+        throw ConfigurationException();
+
+    m_shareFileDirectory =
+            config.get<std::string>("ProtectionDomain.ShareFileDirectory",
+                                    "");
+} catch (Configuration::Exception const &)
+{ std::throw_with_nested(ConfigurationException()); }
 
 } /* namespace sharemind { */
@@ -22,11 +22,23 @@
 
 #include <sharemind/Exception.h>
 #include <sharemind/ExceptionMacros.h>
+#include <cstddef>
 #include <string>
+#include "Facilities/SyscallStatistics.h"
 
 
 namespace sharemind {
 
+/** How floating point arithmetic on shares is computed. */
+enum class FloatArithmetic {
+    /** Every operation is computed by LibSoftfloat. */
+    SoftFloat,
+    /** Correctly rounded operations are computed by the native FPU. */
+    Native,
+    /** As Native, but samples are checked against LibSoftfloat. */
+    Verify
+};
+
 class __attribute__ ((visibility("internal"))) Shared3pConfiguration {
 
 public: /* Types: */
@@ -42,9 +54,45 @@ public: /* Methods: */
     const std::string & modelEvaluatorConfiguration() const noexcept
     { return m_modelEvaluatorConfiguration; }
 
+    std::size_t numWorkerThreads() const noexcept
+    { return m_numWorkerThreads; }
+
+    std::size_t parallelThreshold() const noexcept
+    { return m_parallelThreshold; }
+
+    std::size_t vectorPoolSize() const noexcept
+    { return m_vectorPoolSize; }
+
+    FloatArithmetic floatArithmetic() const noexcept
+    { return m_floatArithmetic; }
+
+    std::size_t floatVerifyInterval() const noexcept
+    { return m_floatVerifyInterval; }
+
+    SyscallStatistics::Format syscallStatisticsFormat() const noexcept
+    { return m_syscallStatisticsFormat; }
+
+    const std::string & syscallStatisticsDirectory() const noexcept
+    { return m_syscallStatisticsDirectory; }
+
+    std::size_t syscallStatisticsSampleInterval() const noexcept
+    { return m_syscallStatisticsSampleInterval; }
+
+    const std::string & shareFileDirectory() const noexcept
+    { return m_shareFileDirectory; }
+
 private: /* Fields: */
 
     std::string m_modelEvaluatorConfiguration;
+    std::size_t m_numWorkerThreads;
+    std::size_t m_parallelThreshold;
+    std::size_t m_vectorPoolSize;
+    FloatArithmetic m_floatArithmetic;
+    std::size_t m_floatVerifyInterval;
+    SyscallStatistics::Format m_syscallStatisticsFormat;
+    std::string m_syscallStatisticsDirectory;
+    std::size_t m_syscallStatisticsSampleInterval;
+    std::string m_shareFileDirectory;
 
 }; /* class Shared3pConfiguration { */
 
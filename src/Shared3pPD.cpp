@@ -39,6 +39,8 @@ Shared3pPD::Shared3pPD(const std::string & pdName,
                        const std::string & pdConfiguration,
                        Shared3pModule & module)
     : m_name(pdName)
+    , m_logger(module.logger())
+    , m_processCounter(0u)
 {
     try {
         Shared3pConfiguration const config(pdConfiguration);
@@ -46,6 +48,31 @@ Shared3pPD::Shared3pPD(const std::string & pdName,
                 std::make_unique<ExecutionModelEvaluator>(
                     module.logger(),
                     config.modelEvaluatorConfiguration());
+        m_compiledTimeModels =
+                std::make_unique<CompiledTimeModels>(
+                    config.modelEvaluatorConfiguration());
+        if (const size_t dropped =
+                    m_compiledTimeModels->verify(*m_modelEvaluator))
+        {
+            m_logger.debug() << "Protection domain '" << m_name << "': "
+                             << dropped << " compiled time models differ "
+                                "from the model evaluator and are not used.";
+        }
+        m_threadPool =
+                std::make_unique<ThreadPool>(config.numWorkerThreads());
+        m_parallelThreshold = config.parallelThreshold();
+        m_vectorPoolSize = config.vectorPoolSize();
+        m_floatArithmetic = config.floatArithmetic();
+        m_floatVerifyInterval = config.floatVerifyInterval();
+#ifdef SHAREMIND_SYSCALL_STATISTICS_ENABLE
+        m_syscallStatisticsFormat = config.syscallStatisticsFormat();
+#else
+        m_syscallStatisticsFormat = SyscallStatistics::Format::None;
+#endif
+        m_syscallStatisticsDirectory = config.syscallStatisticsDirectory();
+        m_syscallStatisticsSampleInterval =
+                config.syscallStatisticsSampleInterval();
+        m_shareFileDirectory = config.shareFileDirectory();
     } catch (Shared3pConfiguration::ConfigurationException const &) {
         std::throw_with_nested(ConfigurationException());
     } catch (ExecutionModelEvaluator::ConfigurationException const &) {
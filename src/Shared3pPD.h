@@ -20,12 +20,18 @@
 #ifndef MOD_SHARED3P_EMU_SHARED3PPD_H
 #define MOD_SHARED3P_EMU_SHARED3PPD_H
 
+#include <atomic>
 #include <memory>
 #include <sharemind/Exception.h>
 #include <sharemind/ExceptionMacros.h>
+#include "Facilities/CompiledTimeModels.h"
 #include "Facilities/CxxRandomEngine.h"
+#include "Facilities/ThreadPool.h"
+#include "Shared3pConfiguration.h"
 
 
+namespace LogHard { class Logger; }
+
 namespace sharemind {
 
 class ExecutionModelEvaluator;
@@ -52,20 +58,75 @@ public: /* Methods: */
     inline const ExecutionModelEvaluator & modelEvaluator() const noexcept
     { return *m_modelEvaluator; }
 
+    /** The time models of modelEvaluator() which need no interpreting. */
+    inline const CompiledTimeModels & compiledTimeModels() const noexcept
+    { return *m_compiledTimeModels; }
+
     inline CxxRandomEngine & rng() noexcept
     { return m_rng; }
 
     inline const CxxRandomEngine & rng() const noexcept
     { return m_rng; }
 
+    inline ThreadPool & threadPool() noexcept
+    { return *m_threadPool; }
+
+    /** Elementwise protocols on vectors at least this long use the pool. */
+    inline size_t parallelThreshold() const noexcept
+    { return m_parallelThreshold; }
+
+    /** The upper limit on the storage of the vector pool of a process. */
+    inline size_t vectorPoolSize() const noexcept
+    { return m_vectorPoolSize; }
+
+    inline FloatArithmetic floatArithmetic() const noexcept
+    { return m_floatArithmetic; }
+
+    /** Every this many native float results are checked in Verify mode. */
+    inline size_t floatVerifyInterval() const noexcept
+    { return m_floatVerifyInterval; }
+
+    /** Statistics are only collected if the module is built with them. */
+    inline SyscallStatistics::Format syscallStatisticsFormat() const noexcept
+    { return m_syscallStatisticsFormat; }
+
+    inline const std::string & syscallStatisticsDirectory() const noexcept
+    { return m_syscallStatisticsDirectory; }
+
+    inline size_t syscallStatisticsSampleInterval() const noexcept
+    { return m_syscallStatisticsSampleInterval; }
+
+    /** The directory of the share files of mmap_vec, empty if disabled. */
+    inline const std::string & shareFileDirectory() const noexcept
+    { return m_shareFileDirectory; }
+
+    /** \returns a new number for naming per process output files. */
+    inline uint64_t newProcessNumber() noexcept
+    { return m_processCounter++; }
+
     inline const std::string & name() const noexcept
     { return m_name; }
 
+    inline const LogHard::Logger & logger() const noexcept
+    { return m_logger; }
+
 private: /* Fields: */
 
     std::string m_name;
+    const LogHard::Logger & m_logger;
     std::unique_ptr<ExecutionModelEvaluator> m_modelEvaluator;
+    std::unique_ptr<CompiledTimeModels> m_compiledTimeModels;
     CxxRandomEngine m_rng;
+    std::unique_ptr<ThreadPool> m_threadPool;
+    size_t m_parallelThreshold;
+    size_t m_vectorPoolSize;
+    FloatArithmetic m_floatArithmetic;
+    size_t m_floatVerifyInterval;
+    SyscallStatistics::Format m_syscallStatisticsFormat;
+    std::string m_syscallStatisticsDirectory;
+    size_t m_syscallStatisticsSampleInterval;
+    std::string m_shareFileDirectory;
+    std::atomic<uint64_t> m_processCounter;
 
 }; /* class Shared3pPD { */
 
@@ -17,16 +17,105 @@
  * For further information, please contact us at sharemind@cyber.ee.
  */
 
+#include <fstream>
+#include <LogHard/Logger.h>
 #include <sharemind/ExecutionModelEvaluator.h>
+#include <sstream>
+#include <unistd.h>
 #include "Shared3pPDPI.h"
 
 
 namespace sharemind {
 
+namespace {
+
+/** At most this many float mismatches of a process are logged in detail. */
+constexpr uint64_t MAX_LOGGED_FLOAT_MISMATCHES = 16u;
+
+} /* namespace { */
+
 Shared3pPDPI::Shared3pPDPI(Shared3pPD & pd)
     : m_pd(pd)
     , m_modelEvaluator(pd.modelEvaluator())
     , m_rng(pd.rng())
+    , m_threadPool(pd.threadPool())
+    , m_profilerCache(pd.modelEvaluator(), pd.compiledTimeModels())
+    , m_syscallStatistics(pd.syscallStatisticsFormat(),
+                          pd.syscallStatisticsSampleInterval())
+    , m_vectorPool(pd.vectorPoolSize())
+    , m_floatChecks(0u)
+    , m_floatMismatches(0u)
 {}
 
+bool Shared3pPDPI::countFloatVerification(size_t checks,
+                                          size_t mismatches) noexcept
+{
+    m_floatChecks += checks;
+    if (mismatches == 0u)
+        return false;
+
+    return m_floatMismatches.fetch_add(mismatches)
+            < MAX_LOGGED_FLOAT_MISMATCHES;
+}
+
+void Shared3pPDPI::logStatistics() const noexcept {
+    try {
+        const VectorPool::Statistics & pool = m_vectorPool.statistics();
+        if (pool.allocations != 0u) {
+            m_pd.logger().debug()
+                    << "Vector pool of a process in protection domain '"
+                    << m_pd.name() << "': " << pool.hits << " of "
+                    << pool.allocations << " allocations reused a vector ("
+                    << (100u * pool.hits / pool.allocations) << "%), "
+                    << pool.releases << " vectors pooled, " << pool.discards
+                    << " freed, " << pool.retainedBytes
+                    << " bytes retained (peak " << pool.peakRetainedBytes
+                    << " bytes).";
+        }
+
+        const uint64_t floatChecks = m_floatChecks;
+        const uint64_t floatMismatches = m_floatMismatches;
+        if (floatMismatches != 0u) {
+            m_pd.logger().warning()
+                    << "Native floating point arithmetic of a process in "
+                       "protection domain '" << m_pd.name() << "' differed "
+                       "from LibSoftfloat in " << floatMismatches << " of "
+                    << floatChecks << " checked results.";
+        } else if (floatChecks != 0u) {
+            m_pd.logger().debug()
+                    << "Native floating point arithmetic of a process in "
+                       "protection domain '" << m_pd.name() << "' matched "
+                       "LibSoftfloat in all " << floatChecks
+                    << " checked results.";
+        }
+    } catch (...) {}
+}
+
+void Shared3pPDPI::writeSyscallStatistics() const noexcept {
+    if (!m_syscallStatistics.enabled() || m_syscallStatistics.empty())
+        return;
+
+    try {
+        std::ostringstream path;
+        path << m_pd.syscallStatisticsDirectory() << '/' << m_pd.name()
+             << "-syscalls-" << ::getpid() << '-' << m_pd.newProcessNumber()
+             << (m_syscallStatistics.format() == SyscallStatistics::Format::Csv
+                 ? ".csv"
+                 : ".json");
+
+        std::ofstream file(path.str());
+        m_syscallStatistics.write(file);
+        file.close();
+
+        if (file) {
+            m_pd.logger().debug() << "Wrote syscall statistics of a process "
+                                     "to '" << path.str() << "'.";
+        } else {
+            m_pd.logger().warning() << "Failed to write syscall statistics "
+                                       "of a process to '" << path.str()
+                                    << "'!";
+        }
+    } catch (...) {}
+}
+
 } /* namespace sharemind { */
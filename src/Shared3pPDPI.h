@@ -20,8 +20,13 @@
 #ifndef MOD_SHARED3P_EMU_SHARED3PPDPI_H
 #define MOD_SHARED3P_EMU_SHARED3PPDPI_H
 
+#include <atomic>
+#include <cstdint>
 #include <sharemind/SharedValueHeap.h>
 
+#include "Facilities/ProfilerCache.h"
+#include "Facilities/SyscallStatistics.h"
+#include "Facilities/VectorPool.h"
 #include "Shared3pPD.h"
 #include "Shared3pVector.h"
 
@@ -53,11 +58,71 @@ public: /* Methods: */
     inline const CxxRandomEngine & rng() const noexcept
     { return m_rng; }
 
+    inline ProfilerCache & profilerCache() noexcept
+    { return m_profilerCache; }
+
+    inline SyscallStatistics & syscallStatistics() noexcept
+    { return m_syscallStatistics; }
+
+    inline ThreadPool & threadPool() noexcept
+    { return m_threadPool; }
+
+    inline size_t parallelThreshold() const noexcept
+    { return m_pd.parallelThreshold(); }
+
+    inline FloatArithmetic floatArithmetic() const noexcept
+    { return m_pd.floatArithmetic(); }
+
+    inline size_t floatVerifyInterval() const noexcept
+    { return m_pd.floatVerifyInterval(); }
+
+    inline const std::string & shareFileDirectory() const noexcept
+    { return m_pd.shareFileDirectory(); }
+
+    inline const LogHard::Logger & logger() const noexcept
+    { return m_pd.logger(); }
+
+    /**
+     * \brief Counts native float results checked against LibSoftfloat.
+     * \returns whether the first of the given mismatches should be logged.
+     */
+    bool countFloatVerification(size_t checks, size_t mismatches) noexcept;
+
+    /** Logs the statistics of the process. */
+    void logStatistics() const noexcept;
+
+    /** Writes the syscall statistics of the process to a file, if enabled. */
+    void writeSyscallStatistics() const noexcept;
+
     template <typename T>
     inline bool isValidHandle(void * hndl) const {
         return m_heap.check<T>(hndl);
     }
 
+    /**
+     * \returns a new registered vector of the given size, recycled from the
+     *          vector pool if possible.
+     */
+    template <typename T>
+    ShareVec<T> * newVector(size_t size) {
+        ShareVec<T> * vec = m_vectorPool.acquire<T>(size);
+        if (!vec)
+            vec = new ShareVec<T>(size);
+
+        registerVector(vec);
+        return vec;
+    }
+
+    /**
+     * \brief Frees the registered vector, after moving its storage to the
+     *        vector pool if it fits there.
+     */
+    template <typename T>
+    bool deleteVector(ShareVec<T> * vec) {
+        m_vectorPool.release(*vec);
+        return freeRegisteredVector(vec);
+    }
+
     template <typename T>
     inline bool registerVector(ShareVec<T> * vec) {
         return m_heap.insert(vec);
@@ -73,7 +138,13 @@ private: /* Fields: */
     Shared3pPD & m_pd;
     ExecutionModelEvaluator & m_modelEvaluator;
     CxxRandomEngine & m_rng;
+    ThreadPool & m_threadPool;
+    ProfilerCache m_profilerCache;
+    SyscallStatistics m_syscallStatistics;
     SharedValueHeap m_heap;
+    VectorPool m_vectorPool;
+    std::atomic<uint64_t> m_floatChecks;
+    std::atomic<uint64_t> m_floatMismatches;
 
 }; /* class Shared3pPDPI { */
 
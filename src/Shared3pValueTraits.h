@@ -280,6 +280,17 @@ DEFINE_TYPE_IN(respective_xor_type, s3p_int64_t, s3p_xor_uint64_t)
 
 #undef DEFINE_TYPE_IN
 
+/*
+ * Unsigned type in which integer shares of type S are computed modulo 2^n.
+ * Narrower types would be promoted to int and signed types overflow, both of
+ * which are undefined for products.
+ */
+template <typename S>
+using wrapping_type = typename std::conditional<
+    (sizeof(S) < sizeof(unsigned)),
+    unsigned,
+    typename std::make_unsigned<S>::type>::type;
+
 } /* namespace sharemind */
 
 #endif /* MOD_SHARED3P_EMU_SHARED3PVALUETRAITS_H */
@@ -20,7 +20,13 @@
 #ifndef MOD_SHARED3P_EMU_SHARED3PVECTOR_H
 #define MOD_SHARED3P_EMU_SHARED3PVECTOR_H
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <sharemind/ShareVector.h>
+#include <type_traits>
 
 #include "Shared3pValueTraits.h"
 
@@ -31,6 +37,17 @@ namespace sharemind {
 template <>
 class __attribute__ ((visibility("internal"))) ShareVec <s3p_bool_t> : public BitShareVec <s3p_bool_t> {
 
+public: /* Types: */
+
+    using block_type = typename BitShareVec<s3p_bool_t>::vector_type::block_type;
+
+    static_assert (std::is_unsigned<block_type>::value &&
+                   sizeof (block_type) <= sizeof (unsigned long long),
+                   "Unexpected block type of bit vectors.");
+
+    /* Bit i of the vector is bit i % blockBits of block i / blockBits. */
+    static constexpr size_t blockBits = std::numeric_limits<block_type>::digits;
+
 public: /* Methods: */
 
     using BitShareVec<s3p_bool_t>::BitShareVec;
@@ -40,6 +57,143 @@ public: /* Methods: */
         return assignBits_ (vec, vec.value_category ());
     }
 
+    inline block_type * blocks () noexcept { return m_vector.data (); }
+    inline const block_type * blocks () const noexcept { return m_vector.data (); }
+
+    inline size_t numBlocks () const noexcept {
+        return (size () + blockBits - 1u) / blockBits;
+    }
+
+    /* The bits of the last block that belong to the vector. */
+    inline block_type lastBlockMask () const noexcept {
+        const size_t used = size () % blockBits;
+        return used == 0u ? ~block_type (0u) : ~(~block_type (0u) << used);
+    }
+
+    /* Sets this = f(a) block by block, the vectors must have equal sizes. */
+    template <typename F>
+    void transformBlocks (const ShareVec& a, F f) {
+        const block_type * const in = a.blocks ();
+        generateBlocks ([&](size_t i) { return f (in[i]); });
+    }
+
+    template <typename F>
+    void transformBlocks (const ShareVec& a, const ShareVec& b, F f) {
+        const block_type * const in1 = a.blocks ();
+        const block_type * const in2 = b.blocks ();
+        generateBlocks ([&](size_t i) { return f (in1[i], in2[i]); });
+    }
+
+    /*
+     * Sets block i of this to f(i). Bits past the end of the last block are
+     * left intact.
+     */
+    template <typename F>
+    void generateBlocks (F f) {
+        const size_t n = numBlocks ();
+        if (n == 0u)
+            return;
+
+        block_type * const out = blocks ();
+        for (size_t i = 0u; i + 1u < n; ++i)
+            out[i] = f (i);
+
+        const block_type mask = lastBlockMask ();
+        out[n - 1u] = (out[n - 1u] & ~mask) | (f (n - 1u) & mask);
+    }
+
+    /* Copies n bits starting from src[from] to this[to...]. */
+    void copyBits (size_t to, const ShareVec& src, size_t from, size_t n) {
+        if (to % blockBits != 0u || from % blockBits != 0u) {
+            for (size_t i = 0u; i < n; ++i)
+                (*this)[to + i] = static_cast<bool> (src[from + i]);
+            return;
+        }
+
+        const size_t whole = n / blockBits;
+        block_type * const out = blocks () + to / blockBits;
+        const block_type * const in = src.blocks () + from / blockBits;
+        std::copy (in, in + whole, out);
+
+        const size_t rest = n % blockBits;
+        if (rest != 0u) {
+            const block_type mask = ~(~block_type (0u) << rest);
+            out[whole] = (out[whole] & ~mask) | (in[whole] & mask);
+        }
+    }
+
+    /* Writes bits [begin, end) to out[0 .. end - begin) one bool each. */
+    void unpackBits (size_t begin, size_t end, bool * out) const noexcept {
+        size_t i = begin;
+        for (; i < end && i % blockBits != 0u; ++i)
+            *out++ = static_cast<bool> ((*this)[i]);
+
+        const block_type * b = blocks () + i / blockBits;
+        for (; end - i >= blockBits; i += blockBits, out += blockBits) {
+            const block_type w = *b++;
+            for (size_t j = 0u; j < blockBits; j += 8u) {
+                // Moves bit k of the byte to byte k and normalizes it to 1:
+                const uint64_t spread =
+                        (((w >> j) & 0xffu) * UINT64_C (0x0101010101010101))
+                        & UINT64_C (0x8040201008040201);
+                const uint64_t bytes =
+                        (((spread + UINT64_C (0x7f7f7f7f7f7f7f7f)) | spread)
+                         & UINT64_C (0x8080808080808080)) >> 7u;
+                memcpy (out + j, &bytes, sizeof (bytes));
+            }
+        }
+
+        for (; i < end; ++i)
+            *out++ = static_cast<bool> ((*this)[i]);
+    }
+
+    /*
+     * Sets bits [begin, end) from in[0 .. end - begin). Only the blocks that
+     * hold these bits are written, so ranges that start at multiples of
+     * blockBits can be packed concurrently.
+     */
+    void packBits (size_t begin, size_t end, const bool * in) noexcept {
+        size_t i = begin;
+        for (; i < end && i % blockBits != 0u; ++i)
+            (*this)[i] = *in++;
+
+        block_type * b = blocks () + i / blockBits;
+        for (; end - i >= blockBits; i += blockBits, in += blockBits) {
+            block_type w = 0u;
+            for (size_t j = 0u; j < blockBits; j += 8u) {
+                // Gathers the bit of byte k to bit k + 56 of the product:
+                uint64_t bytes;
+                memcpy (&bytes, in + j, sizeof (bytes));
+                const uint64_t packed =
+                        (bytes * UINT64_C (0x0102040810204080)) >> 56u;
+                w |= static_cast<block_type> (packed) << j;
+            }
+            *b++ = w;
+        }
+
+        for (; i < end; ++i)
+            (*this)[i] = *in++;
+    }
+
+    /* The number of set bits in [begin, end). */
+    size_t countOnes (size_t begin, size_t end) const noexcept {
+        if (begin >= end)
+            return 0u;
+
+        const block_type * const b = blocks ();
+        const size_t first = begin / blockBits;
+        const size_t last = (end - 1u) / blockBits;
+        const block_type low = ~block_type (0u) << (begin % blockBits);
+        const block_type high = ~block_type (0u) >> (blockBits - 1u - (end - 1u) % blockBits);
+
+        if (first == last)
+            return popcount_ (b[first] & low & high);
+
+        return popcount_ (b[first] & low)
+             + countOnes_ (b + first + 1u, b + last)
+             + popcount_ (b[last] & high);
+    }
+
 private: /* Methods: */
 
     template <typename T>
@@ -52,6 +206,36 @@ private: /* Methods: */
         m_vector.assignBits (vec.begin (), vec.end ());
     }
 
+    static inline size_t popcount_ (block_type x) noexcept {
+        return static_cast<size_t> (__builtin_popcountll (x));
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    __attribute__ ((target("popcnt")))
+    static size_t countOnesPopcnt_ (const block_type * begin,
+                                    const block_type * end) noexcept
+    {
+        size_t n = 0u;
+        for (; begin != end; ++begin)
+            n += static_cast<size_t> (__builtin_popcountll (*begin));
+        return n;
+    }
+#endif
+
+    static size_t countOnes_ (const block_type * begin,
+                              const block_type * end) noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        static const bool havePopcnt = __builtin_cpu_supports ("popcnt");
+        if (havePopcnt)
+            return countOnesPopcnt_ (begin, end);
+#endif
+        size_t n = 0u;
+        for (; begin != end; ++begin)
+            n += popcount_ (*begin);
+        return n;
+    }
+
 }; /* class ShareVec <s3p_bool_t> { */
 
 
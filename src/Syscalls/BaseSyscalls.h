@@ -32,19 +32,82 @@ namespace sharemind {
 
 namespace {
 
+/* Large copies are split between the threads in chunks of this many bytes: */
+constexpr size_t PARALLEL_COPY_BYTES = 1u << 20u;
+
+template <typename T>
+constexpr size_t copyGrainSize() noexcept {
+    return PARALLEL_COPY_BYTES / sizeof(typename ValueTraits<T>::share_type);
+}
+
+/* Copies src[offset, offset + size) to dest[0, size). */
 template <typename T>
-inline void copy_shares(const ShareVec<T> & src,
+inline void copy_shares(Shared3pPDPI & pdpi,
+                        const ShareVec<T> & src,
+                        size_t offset,
+                        size_t size,
                         typename ValueTraits<T>::share_type * dest)
 {
-    std::copy(src.begin(), src.end(), dest);
+    pdpi.threadPool().parallelFor(size, copyGrainSize<T>(),
+        [&src, offset, dest](size_t begin, size_t end) {
+            std::copy(src.begin() + offset + begin,
+                      src.begin() + offset + end,
+                      dest + begin);
+        });
 }
 
 template <>
-inline void copy_shares<s3p_bool_t>(const ShareVec<s3p_bool_t> & src,
+inline void copy_shares<s3p_bool_t>(Shared3pPDPI & pdpi,
+                                     const ShareVec<s3p_bool_t> & src,
+                                     size_t offset,
+                                     size_t size,
                                      s3p_bool_t::share_type * dest)
 {
-    for (size_t i = 0u; i < src.size(); ++i)
-        dest[i] = src[i];
+    // Reading a bit vector concurrently is safe:
+    pdpi.threadPool().parallelFor(size, copyGrainSize<s3p_bool_t>(),
+        [&src, offset, dest](size_t begin, size_t end) {
+            src.unpackBits(offset + begin, offset + end, dest + begin);
+        });
+}
+
+/* Copies src[0, size) to dest[offset, offset + size). */
+template <typename T>
+inline void assign_shares(Shared3pPDPI & pdpi,
+                          const typename ValueTraits<T>::share_type * src,
+                          size_t size,
+                          ShareVec<T> & dest,
+                          size_t offset)
+{
+    pdpi.threadPool().parallelFor(size, copyGrainSize<T>(),
+        [src, &dest, offset](size_t begin, size_t end) {
+            std::copy(src + begin, src + end, dest.begin() + offset + begin);
+        });
+}
+
+template <>
+inline void assign_shares<s3p_bool_t>(Shared3pPDPI & pdpi,
+                                      const s3p_bool_t::share_type * src,
+                                      size_t size,
+                                      ShareVec<s3p_bool_t> & dest,
+                                      size_t offset)
+{
+    constexpr size_t blockBits = ShareVec<s3p_bool_t>::blockBits;
+    static_assert(copyGrainSize<s3p_bool_t>() % blockBits == 0u,
+                  "The chunks must not share blocks.");
+
+    // Pack the bits up to the first block boundary on this thread:
+    const size_t head = std::min(size, (blockBits - offset % blockBits)
+                                       % blockBits);
+    dest.packBits(offset, offset + head, src);
+    src += head;
+    size -= head;
+    offset += head;
+
+    // The chunks start at block boundaries, so no block is written twice:
+    pdpi.threadPool().parallelFor(size, copyGrainSize<s3p_bool_t>(),
+        [src, &dest, offset](size_t begin, size_t end) {
+            dest.packBits(offset + begin, offset + end, src + begin);
+        });
 }
 
 } /* anonymous namespace */
@@ -82,12 +145,11 @@ NAMED_SYSCALL(new_vec, name, args, num_args, refs, crefs, returnValue, c)
         Shared3pPDPI * const pdpi = static_cast<Shared3pPDPI*>(handles.pdpiHandle);
         const size_t vsize = args[1u].uint64[0u];
 
-        ShareVec<T> * const vec = new ShareVec<T>(vsize);
-        pdpi->registerVector(vec);
+        ShareVec<T> * const vec = pdpi->newVector<T>(vsize);
 
         returnValue->p[0u] = vec;
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name, vsize);
+        PROFILE_SYSCALL(c, *pdpi, name, vsize);
 
         return SHAREMIND_MODULE_API_0x1_OK;
     } catch (...) {
@@ -127,7 +189,7 @@ NAMED_SYSCALL(init_vec, name, args, num_args, refs, crefs, returnValue, c)
         for (size_t i = 0u; i < vec.size(); ++i)
             vec[i] = init;
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         vec.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -178,13 +240,13 @@ NAMED_SYSCALL(set_shares, name, args, num_args, refs, crefs, returnValue, c)
             if (dest.size() != num_elems)
                 return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-            dest.assign(src, src + num_elems);
+            assign_shares(*pdpi, src, num_elems, dest, 0u);
         }
 
         if (returnValue)
             returnValue->uint64[0u] = num_elems;
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         num_elems);
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -235,13 +297,13 @@ NAMED_SYSCALL(get_shares, name, args, num_args, refs, crefs, returnValue, c)
                 return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
             share_type * const dest = static_cast<share_type *>(refs[0u].pData);
-            copy_shares (src, dest);
+            copy_shares(*pdpi, src, 0u, src.size(), dest);
         }
 
         if (returnValue)
             returnValue->uint64[0u] = num_bytes;
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         src.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -250,6 +312,102 @@ NAMED_SYSCALL(get_shares, name, args, num_args, refs, crefs, returnValue, c)
     }
 }
 
+/**
+ * SysCall: set_shares_range<T>
+ * Stack:
+ *      0) uint64[0u]     pd index
+ *      1) p[0u]          destination handle
+ *      2) uint64[0u]     index of the first element to set
+ * CRef: memory to copy the shares from
+ * Unlike set_shares, the shares may be set a part at a time, so that a large
+ * vector can be imported through a small buffer in the VM.
+ */
+template<typename T>
+NAMED_SYSCALL(set_shares_range, name, args, num_args, refs, crefs, returnValue, c)
+{
+    VMHandles handles;
+    if (!SyscallArgs<3, false, 0, 1>::check(num_args, refs, crefs, returnValue) ||
+        !handles.get(c, args)) {
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    }
+
+    try {
+        Shared3pPDPI * const pdpi = static_cast<Shared3pPDPI*>(handles.pdpiHandle);
+
+        if (!pdpi->isValidHandle<T>(args[1u].p[0u]))
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        typedef typename ValueTraits<T>::share_type share_type;
+        const share_type* src = static_cast<const share_type*>(crefs[0u].pData);
+        /** \todo the following is a workaround! We are always allocating
+             one byte too much (for arrays) as VM does not allow us to allocate
+             0 sized memory block. */
+        const size_t num_elems = (crefs[0u].size - 1) / sizeof(share_type);
+        const uint64_t offset = args[2u].uint64[0u];
+
+        ShareVec<T> & dest = *static_cast<ShareVec<T>*>(args[1u].p[0u]);
+        if (offset > dest.size() || num_elems > dest.size() - offset)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        assign_shares(*pdpi, src, num_elems, dest, offset);
+
+        PROFILE_SYSCALL(c, *pdpi, name,
+                        num_elems);
+
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (...) {
+        return catchModuleApiErrors ();
+    }
+}
+
+/**
+ * SysCall: get_shares_range<T>
+ * Stack:
+ *      0) uint64[0u]     pd index
+ *      1) p[0u]          source handle
+ *      2) uint64[0u]     index of the first element to get
+ * Ref: memory to copy the shares to
+ * Unlike get_shares, the shares may be read a part at a time, so that a large
+ * vector can be exported through a small buffer in the VM.
+ */
+template<typename T>
+NAMED_SYSCALL(get_shares_range, name, args, num_args, refs, crefs, returnValue, c)
+{
+    VMHandles handles;
+    if (!SyscallArgs<3, false, 1, 0>::check(num_args, refs, crefs, returnValue) ||
+        !handles.get(c, args)) {
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    }
+
+    try {
+        Shared3pPDPI * const pdpi = static_cast<Shared3pPDPI*>(handles.pdpiHandle);
+
+        if (!pdpi->isValidHandle<T>(args[1u].p[0u]))
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        typedef typename ValueTraits<T>::share_type share_type;
+        share_type * const dest = static_cast<share_type *>(refs[0u].pData);
+        /** \todo the following is a workaround! We are always allocating
+             one byte too much (for arrays) as VM does not allow us to allocate
+             0 sized memory block. */
+        const size_t num_elems = (refs[0u].size - 1) / sizeof(share_type);
+        const uint64_t offset = args[2u].uint64[0u];
+
+        const ShareVec<T> & src = *static_cast<const ShareVec<T>*>(args[1u].p[0u]);
+        if (offset > src.size() || num_elems > src.size() - offset)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        copy_shares(*pdpi, src, offset, num_elems, dest);
+
+        PROFILE_SYSCALL(c, *pdpi, name,
+                        num_elems);
+
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (...) {
+        return catchModuleApiErrors ();
+    }
+}
+
 /**
  * SysCall: get_type_size<T>
  * Stack:
@@ -282,7 +440,7 @@ NAMED_SYSCALL(get_type_size, name, args, num_args, refs, crefs, returnValue, c)
         typedef typename ValueTraits<T>::share_type share_type;
         returnValue->uint64[0u] = sizeof(share_type);
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name, 0u);
+        PROFILE_SYSCALL(c, *pdpi, name, 0u);
 
         return SHAREMIND_MODULE_API_0x1_OK;
     } catch (...) {
@@ -327,7 +485,7 @@ NAMED_SYSCALL(fill_vec, name, args, num_args, refs, crefs, returnValue, c)
         for (size_t i = 0; i < dest.size(); ++i)
             dest[i] = src[0u];
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         dest.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -378,7 +536,7 @@ NAMED_SYSCALL(assign_vec, name, args, num_args, refs, crefs, returnValue, c)
 
         dest.assign(src);
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         dest.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -426,7 +584,7 @@ NAMED_SYSCALL(declassify_vec, name, args, num_args, refs, crefs, returnValue, c)
         for (size_t i = 0u; i < src.size(); ++i)
             dest[i] = src[i];
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         src.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -474,7 +632,7 @@ NAMED_SYSCALL(classify_vec, name, args, num_args, refs, crefs, returnValue, c)
         for (size_t i = 0u; i < dest.size(); ++i)
             dest[i] = src[i];
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         src.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -514,9 +672,9 @@ NAMED_SYSCALL(delete_vec, name, args, num_args, refs, crefs, returnValue, c)
 
         ShareVec<T> * vec = static_cast<ShareVec<T>*>(vecHandle);
         const size_t vsize = vec->size();
-        pdpi->freeRegisteredVector(vec);
+        pdpi->deleteVector(vec);
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name, vsize);
+        PROFILE_SYSCALL(c, *pdpi, name, vsize);
 
         return SHAREMIND_MODULE_API_0x1_OK;
     } catch (...) {
@@ -570,7 +728,7 @@ NAMED_SYSCALL(load_vec, name, args, num_args, refs, crefs, returnValue, c)
 
         dest[0u] = src[index];
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name, 1u);
+        PROFILE_SYSCALL(c, *pdpi, name, 1u);
 
         return SHAREMIND_MODULE_API_0x1_OK;
     } catch (...) {
@@ -624,7 +782,7 @@ NAMED_SYSCALL(store_vec, name, args, num_args, refs, crefs, returnValue, c)
 
         dest[index] = src[0u];
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name, 1u);
+        PROFILE_SYSCALL(c, *pdpi, name, 1u);
 
         return SHAREMIND_MODULE_API_0x1_OK;
     } catch (...) {
@@ -667,7 +825,7 @@ NAMED_SYSCALL(scatter, name, args, num_args, refs, crefs, returnValue, c)
                 return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
         }
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name, src.size());
+        PROFILE_SYSCALL(c, *pdpi, name, src.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
     } catch (...) {
@@ -710,7 +868,7 @@ NAMED_SYSCALL(gather, name, args, num_args, refs, crefs, returnValue, c)
                 return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
         }
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name, dest.size());
+        PROFILE_SYSCALL(c, *pdpi, name, dest.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
     } catch (...) {
@@ -30,7 +30,7 @@ namespace sharemind {
 namespace /* anonymous */ {
 
 template <CRCMode mode>
-void init_crc_table (typename CRCModeInfo<mode>::share_type table[256]) {
+void init_crc_table (typename CRCModeInfo<mode>::share_type table[CRC_SLICES][256]) {
     typedef typename CRCModeInfo<mode>::share_type share_type;
     for (size_t n = 0; n < 256; ++ n) {
         share_type c = static_cast<share_type>(n);
@@ -41,7 +41,14 @@ void init_crc_table (typename CRCModeInfo<mode>::share_type table[256]) {
                 c = c >> 1;
         }
 
-        table[n] = c;
+        table[0][n] = c;
+    }
+
+    for (size_t k = 1; k < CRC_SLICES; ++ k) {
+        for (size_t n = 0; n < 256; ++ n) {
+            const share_type c = table[k - 1][n];
+            table[k][n] = (c >> 8) ^ table[0][c & 0xff];
+        }
     }
 }
 
@@ -62,8 +69,8 @@ CRCTableInitializer CRCTableInitializer::m_instance;
 } /* namespace anonymous */
 
 
-CRCModeInfo<CRCMode16>::share_type CRCModeInfo<CRCMode16>::table[256];
-CRCModeInfo<CRCMode32>::share_type CRCModeInfo<CRCMode32>::table[256];
+CRCModeInfo<CRCMode16>::share_type CRCModeInfo<CRCMode16>::table[CRC_SLICES][256];
+CRCModeInfo<CRCMode32>::share_type CRCModeInfo<CRCMode32>::table[CRC_SLICES][256];
 
 template <CRCMode mode>
 NAMED_SYSCALL(crc_xor_vec, name, args, num_args, refs, crefs, returnValue, c)
@@ -95,11 +102,11 @@ NAMED_SYSCALL(crc_xor_vec, name, args, num_args, refs, crefs, returnValue, c)
             return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
         }
 
-        if (! CRCProtocol<mode>().invoke (inputVec, output[0])) {
+        if (! CRCProtocol<mode>(pdpi).invoke (inputVec, output[0])) {
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
         }
 
-        PROFILE_SYSCALL(c, pdpi.modelEvaluator(), name,
+        PROFILE_SYSCALL(c, pdpi, name,
                         inputVec.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
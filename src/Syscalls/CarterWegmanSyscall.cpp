@@ -22,48 +22,68 @@
 #include "../Shared3pPDPI.h"
 #include "../Shared3pVector.h"
 
+#include <algorithm>
 #include <sharemind/VmVector.h>
+#include <vector>
 
 namespace sharemind {
 
-bool CarterWegman128Protocol(const ShareVec<s3p_xor_uint8_t>& keyVec,
+namespace /* anonymous */ {
+
+constexpr size_t HASH_BITS = 128u;
+constexpr size_t HASH_BYTES = HASH_BITS / 8u;
+
+/* Packs len bytes to little-endian 64-bit words, padding with zeroes. */
+template <typename Iterator>
+void packWords(Iterator bytes, size_t len, uint64_t * words) {
+    const size_t numWords = (len + 7u) / 8u;
+    std::fill(words, words + numWords, 0u);
+    for (size_t i = 0u; i < len; ++i, ++bytes)
+        words[i / 8u] |= static_cast<uint64_t>(*bytes) << (8u * (i % 8u));
+}
+
+} /* namespace anonymous */
+
+/*
+ * Bit i of the hash of a row is the parity of the bitwise and of the row and
+ * the i-th row of the key. The rows are processed as 64-bit words, the ands
+ * of all the words are accumulated with xor and the parity of the
+ * accumulator is taken once.
+ */
+bool CarterWegman128Protocol(Shared3pPDPI & pdpi,
+                             const ShareVec<s3p_xor_uint8_t>& keyVec,
                              const ShareVec<s3p_xor_uint8_t>& dataVec,
                              ShareVec<s3p_xor_uint8_t>& resultVec)
 {
-    size_t rowLen = keyVec.size() / 128;
-    size_t rows = dataVec.size() / rowLen;
-
-    for (size_t row = 0; row < rows; ++row) {
-        ShareVec<s3p_xor_uint8_t> hash(16);
-
-        for (size_t i = 0; i < 128; ++i) {
-            uint8_t bit = 0;
-
-            for (size_t byteI = 0; byteI < rowLen; ++byteI) {
-                uint8_t byte = dataVec[rowLen * row + byteI];
-                uint8_t x = byte & keyVec[i * rowLen + byteI];
-
-                // Sum x bits
-                for (size_t j = 0; j < 8; ++j) {
-                    // Mask other bits
-                    uint8_t tmp = x & (static_cast<uint8_t>(1) << static_cast<uint8_t>(j));
-                    // Move to the right
-                    tmp = tmp >> static_cast<uint8_t>(j);
-                    // Xor with bit
-                    bit = bit ^ tmp;
+    const size_t rowLen = keyVec.size() / HASH_BITS;
+    const size_t rows = dataVec.size() / rowLen;
+    const size_t rowWords = (rowLen + 7u) / 8u;
+
+    std::vector<uint64_t> key(HASH_BITS * rowWords);
+    for (size_t i = 0u; i < HASH_BITS; ++i)
+        packWords(keyVec.begin() + i * rowLen, rowLen, &key[i * rowWords]);
+
+    const size_t grainSize = std::max(size_t(1u), size_t(4096u) / (rowWords + 1u));
+    pdpi.threadPool().parallelFor(rows, grainSize, [&](size_t begin, size_t end) {
+        std::vector<uint64_t> data(rowWords);
+        for (size_t row = begin; row < end; ++row) {
+            packWords(dataVec.begin() + row * rowLen, rowLen, data.data());
+
+            for (size_t byteI = 0u; byteI < HASH_BYTES; ++byteI) {
+                uint8_t hashByte = 0u;
+                for (size_t j = 0u; j < 8u; ++j) {
+                    const uint64_t * const keyRow = &key[(8u * byteI + j) * rowWords];
+                    uint64_t acc = 0u;
+                    for (size_t w = 0u; w < rowWords; ++w)
+                        acc ^= data[w] & keyRow[w];
+
+                    hashByte |= static_cast<uint8_t>(__builtin_parityll(acc) << (7u - j));
                 }
-            }
 
-            size_t resByte = i / 8;
-            size_t resBit = i % 8;
-            hash[resByte] = hash[resByte] | (bit << (7 - resBit));
-        }
-
-        // Assign hash of this row to resultVec
-        for (size_t i = 0; i < 16; ++i) {
-            resultVec[row * 16 + i] = hash[i];
+                resultVec[row * HASH_BYTES + byteI] = hashByte;
+            }
         }
-    }
+    });
 
     return true;
 }
@@ -112,7 +132,14 @@ NAMED_SYSCALL(carter_wegman128, name, args, num_args, refs, crefs, returnValue,
         ShareVec<s3p_xor_uint8_t>& resultVec =
             *static_cast<ShareVec<s3p_xor_uint8_t> *>(resultHandle);
 
-        if (!CarterWegman128Protocol(keyVec, dataVec, resultVec)) {
+        // Check whether the vectors have proper size:
+        if (keyVec.size() < HASH_BITS
+            || resultVec.size() < (dataVec.size() / (keyVec.size() / HASH_BITS)) * HASH_BYTES)
+        {
+            return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+        }
+
+        if (!CarterWegman128Protocol(*pdpi, keyVec, dataVec, resultVec)) {
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
         }
 
@@ -27,6 +27,8 @@
 #include <sharemind/module-apis/api_0x1.h>
 #include <sharemind/SyscallsCommon.h>
 #include <sstream>
+#include "../Facilities/ProfilerCache.h"
+#include "../Shared3pPDPI.h"
 #include "../Shared3pValueTraits.h"
 
 namespace sharemind {
@@ -103,6 +105,63 @@ inline sf_float64 getStack<s3p_float64_t>(const SharemindCodeBlock & arg)
             SharemindCodeBlock * retVal, \
             SharemindModuleApi0x1SyscallContext * c)
 
+#ifdef SHAREMIND_SYSCALL_STATISTICS_ENABLE
+/**
+ * Invokes the syscall and records it in the syscall statistics of the process,
+ * if these are enabled. Only sampled calls are timed.
+ */
+template <typename Syscall>
+inline SharemindModuleApi0x1Error timeSyscall(
+        const char * name,
+        SharemindCodeBlock * args,
+        size_t argc,
+        SharemindModuleApi0x1SyscallContext * c,
+        Syscall syscall)
+{
+    VMHandles handles;
+    if (argc == 0u || !handles.get(c, args))
+        return syscall();
+
+    SyscallStatistics & statistics =
+            static_cast<Shared3pPDPI *>(handles.pdpiHandle)->syscallStatistics();
+    if (!statistics.enabled())
+        return syscall();
+
+    if (!statistics.sampleNext()) {
+        const SharemindModuleApi0x1Error result = syscall();
+        statistics.record(name);
+        return result;
+    }
+
+    const uint64_t start = SyscallStatistics::now();
+    const SharemindModuleApi0x1Error result = syscall();
+    statistics.record(name, SyscallStatistics::now() - start);
+    return result;
+}
+
+#define NAMED_SYSCALL_WRAPPER(name,...) \
+    SharemindModuleApi0x1Error name( \
+        SharemindCodeBlock * args, \
+        size_t argc, \
+        const SharemindModuleApi0x1Reference * refs, \
+        const SharemindModuleApi0x1CReference * crefs, \
+        SharemindCodeBlock * retVal, \
+        SharemindModuleApi0x1SyscallContext * c); \
+    SharemindModuleApi0x1Error name( \
+        SharemindCodeBlock * args, \
+        size_t argc, \
+        const SharemindModuleApi0x1Reference * refs, \
+        const SharemindModuleApi0x1CReference * crefs, \
+        SharemindCodeBlock * retVal, \
+        SharemindModuleApi0x1SyscallContext * c) \
+    { \
+        return sharemind::timeSyscall(("shared3p::" #name), args, argc, c, \
+            [&]() { \
+                return __VA_ARGS__(("shared3p::" #name), args, argc, refs, \
+                                   crefs, retVal, c); \
+            }); \
+    }
+#else
 #define NAMED_SYSCALL_WRAPPER(name,...) \
     SharemindModuleApi0x1Error name( \
         SharemindCodeBlock * args, \
@@ -121,45 +180,50 @@ inline sf_float64 getStack<s3p_float64_t>(const SharemindCodeBlock & arg)
     { \
         return __VA_ARGS__(("shared3p::" #name), args, argc, refs, crefs, retVal, c); \
     }
+#endif
 
 #define NAMED_SYSCALL_DEFINITION(signature,fptr) \
   { (signature), &(fptr) }
 
 
+#ifdef SHAREMIND_SYSCALL_STATISTICS_ENABLE
+#define RECORD_SYSCALL_ELEMENTS(pdpi,elements) \
+    (pdpi).syscallStatistics().setElements((elements))
+#else
+#define RECORD_SYSCALL_ELEMENTS(pdpi,elements) static_cast<void>(0)
+#endif
+
 /**
- * Macros for profiling syscalls
+ * Macros for profiling syscalls. The profiler facility, section type and time
+ * model of the syscall are resolved once per process instance.
  */
 /// \todo evaluate() returns double. Make sure we can cast it to UsTime.
 #ifdef SHAREMIND_NETWORK_STATISTICS_ENABLE
-#define PROFILE_SYSCALL(ctx,evaluator,name,parameter) \
+#define PROFILE_SYSCALL(ctx,pdpi,name,parameter) \
     do { \
-        if (auto * const profiler = static_cast<ExecutionProfiler *>( \
-                ctx->processFacility(ctx, "Profiler"))) \
-        { \
-            static const uint32_t sectionTypeId = \
-                profiler->newSectionType((name)); \
-            sharemind::ExecutionModelEvaluator::Model * const timeModel = \
-                (evaluator).model("TimeModel", (name)); \
-            if (timeModel) \
-                profiler->addSection(sectionTypeId, (parameter), 0u, \
-                        static_cast<UsTime>(timeModel->evaluate((parameter))), \
+        RECORD_SYSCALL_ELEMENTS((pdpi), (parameter)); \
+        sharemind::ProfilerCache & profilerCache = (pdpi).profilerCache(); \
+        if (auto * const profiler = profilerCache.profiler((ctx))) { \
+            const auto & profiled = profilerCache.entry((name)); \
+            if (profiled.hasTimeModel()) \
+                profiler->addSection(profiled.sectionTypeId, (parameter), 0u, \
+                        static_cast<UsTime>( \
+                            profiled.evaluateTime((parameter))), \
                         sharemind::MinerNetworkStatistics(), \
                         sharemind::MinerNetworkStatistics()); \
         } \
     } while (false)
 #else
-#define PROFILE_SYSCALL(ctx,evaluator,name,parameter) \
+#define PROFILE_SYSCALL(ctx,pdpi,name,parameter) \
     do { \
-        if (auto * const profiler = static_cast<ExecutionProfiler *>( \
-                ctx->processFacility(ctx, "Profiler"))) \
-        { \
-            static const uint32_t sectionTypeId = \
-                profiler->newSectionType((name)); \
-            sharemind::ExecutionModelEvaluator::Model * const timeModel = \
-                (evaluator).model("TimeModel", (name)); \
-            if (timeModel) \
-                profiler->addSection(sectionTypeId, (parameter), 0u, \
-                        static_cast<UsTime>(timeModel->evaluate((parameter))));\
+        RECORD_SYSCALL_ELEMENTS((pdpi), (parameter)); \
+        sharemind::ProfilerCache & profilerCache = (pdpi).profilerCache(); \
+        if (auto * const profiler = profilerCache.profiler((ctx))) { \
+            const auto & profiled = profilerCache.entry((name)); \
+            if (profiled.hasTimeModel()) \
+                profiler->addSection(profiled.sectionTypeId, (parameter), 0u, \
+                        static_cast<UsTime>( \
+                            profiled.evaluateTime((parameter)))); \
         } \
     } while (false)
 #endif
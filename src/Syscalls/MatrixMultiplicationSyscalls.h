@@ -78,11 +78,11 @@ NAMED_SYSCALL(mat_mult, name, args, num_args, refs, crefs, returnValue, c)
         if (mat1.size() != l1 || mat2.size() != l2 || result.size() != l3)
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        if (! MatrixMultiplicationProtocol().invoke(mat1, mat2, dim1, dim2, dim3, result,
-                                                    typename ValueTraits<T>::value_category{}))
+        if (! MatrixMultiplicationProtocol(*pdpi).invoke(mat1, mat2, dim1, dim2, dim3, result,
+                                                         typename ValueTraits<T>::value_category{}))
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name, l1 + l2);
+        PROFILE_SYSCALL(c, *pdpi, name, l1 + l2);
 
         return SHAREMIND_MODULE_API_0x1_OK;
     } catch (...) {
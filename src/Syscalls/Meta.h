@@ -20,10 +20,16 @@
 #ifndef MOD_SHARED3P_EMU_SYSCALLS_META_H
 #define MOD_SHARED3P_EMU_SYSCALLS_META_H
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <sharemind/module-apis/api_0x1.h>
 #include <sharemind/VmVector.h>
+#include <type_traits>
+#include <vector>
 
 #include "Common.h"
+#include "../Protocols/ProtocolTraits.h"
 #include "../Shared3pPDPI.h"
 
 
@@ -33,6 +39,108 @@
 
 namespace sharemind {
 
+namespace {
+
+inline bool sizesEqual(size_t) noexcept { return true; }
+
+template <typename ... Sizes>
+inline bool sizesEqual(size_t size, size_t first, Sizes ... rest) noexcept
+{ return size == first && sizesEqual(size, rest...); }
+
+template <typename T>
+std::unique_ptr<ShareVec<T> > copySlice(const ShareVec<T> & vec,
+                                        size_t begin,
+                                        size_t end)
+{
+    auto slice = std::make_unique<ShareVec<T> >(end - begin);
+    for (size_t i = begin; i < end; ++i)
+        (*slice)[i - begin] = vec[i];
+    return slice;
+}
+
+inline std::unique_ptr<ShareVec<s3p_bool_t> > copySlice(
+        const ShareVec<s3p_bool_t> & vec,
+        size_t begin,
+        size_t end)
+{
+    auto slice = std::make_unique<ShareVec<s3p_bool_t> >(end - begin);
+    slice->copyBits(0u, vec, begin, end - begin);
+    return slice;
+}
+
+template <typename T>
+void storeSlice(ShareVec<T> & vec, size_t begin, const ShareVec<T> & slice) {
+    for (size_t i = 0u; i < slice.size(); ++i)
+        vec[begin + i] = slice[i];
+}
+
+inline void storeSlice(ShareVec<s3p_bool_t> & vec,
+                       size_t begin,
+                       const ShareVec<s3p_bool_t> & slice)
+{ vec.copyBits(begin, slice, 0u, slice.size()); }
+
+/**
+ * Invokes the protocol as protocol.invoke(params..., result). Vectors of at
+ * least pdpi.parallelThreshold() elements given to elementwise protocols are
+ * split into slices which are processed on the thread pool of the protection
+ * domain. The result vector is only written if all slices succeed.
+ */
+template <typename Protocol, typename R, typename ... Ps>
+bool invokeProtocol(Shared3pPDPI & pdpi,
+                    ShareVec<R> & result,
+                    const ShareVec<Ps> & ... params)
+{
+    const size_t size = result.size();
+    ThreadPool & pool = pdpi.threadPool();
+
+    if (!is_elementwise_protocol<Protocol>::value ||
+            pool.numThreads() == 1u ||
+            size == 0u ||
+            size < pdpi.parallelThreshold() ||
+            !sizesEqual(size, params.size()...))
+    {
+        Protocol protocol(pdpi);
+        return protocol.invoke(params..., result);
+    }
+
+    // Multiple of 64 so that the slices of bit vectors start on word borders:
+    const size_t grainSize =
+            ((size - 1u) / (4u * pool.numThreads()) / 64u + 1u) * 64u;
+    std::vector<std::unique_ptr<ShareVec<R> > > slices(
+            (size - 1u) / grainSize + 1u);
+    std::atomic<bool> ok(true);
+
+    pool.parallelFor(size, grainSize,
+        [&](size_t begin, size_t end) {
+            // Protocols may leave some outputs untouched, keep those intact:
+            auto slice = copySlice(result, begin, end);
+            Protocol protocol(pdpi);
+            if (!protocol.invoke(*copySlice(params, begin, end)..., *slice))
+                ok = false;
+            slices[begin / grainSize] = std::move(slice);
+        });
+
+    if (!ok)
+        return false;
+
+    const auto store = [&](size_t begin, size_t end) {
+        (void) end;
+        storeSlice(result, begin, *slices[begin / grainSize]);
+    };
+
+    // Concurrent writes to the same bit vector are not safe:
+    if (std::is_same<R, s3p_bool_t>::value) {
+        for (size_t begin = 0u; begin < size; begin += grainSize)
+            store(begin, std::min(begin + grainSize, size));
+    } else {
+        pool.parallelFor(size, grainSize, store);
+    }
+
+    return true;
+}
+
+} /* namespace { */
+
 /**
  * SysCall: binary_vec<T1, T2, T3, Protocol>
  * Args:
@@ -73,11 +181,10 @@ NAMED_SYSCALL(binary_vec, name, args, num_args, refs, crefs, returnValue, c)
         const ShareVec<T2> & param2 = *static_cast<ShareVec<T2>*>(rhsHandle);
         ShareVec<T3> & result = *static_cast<ShareVec<T3>*>(resultHandle);
 
-        Protocol protocol(*pdpi);
-        if (!protocol.invoke(param1, param2, result))
+        if (!invokeProtocol<Protocol>(*pdpi, result, param1, param2))
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         param1.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -127,7 +234,7 @@ NAMED_SYSCALL(binary_public_vec, name, args, num_args, refs, crefs, returnValue,
         if (!protocol.invoke(param1, param2, result))
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         param1.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -203,11 +310,10 @@ NAMED_SYSCALL(unary_vec, name, args, num_args, refs, crefs, returnValue, c)
         const ShareVec<T>& param = *static_cast<ShareVec<T>*>(paramHandle);
         ShareVec<L>& result = *static_cast<ShareVec<L>*>(resultHandle);
 
-        Protocol protocol(*pdpi);
-        if (!protocol.invoke(param, result))
+        if (!invokeProtocol<Protocol>(*pdpi, result, param))
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         param.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -263,7 +369,7 @@ NAMED_SYSCALL(nullary_vec, name, args, num_args, refs, crefs, returnValue, c)
         if (!Protocol(*pdpi).invoke(result))
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         result.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
@@ -317,11 +423,10 @@ NAMED_SYSCALL(ternary_vec, name, args, num_args, refs, crefs, returnValue, c)
         const ShareVec<T3> & param3 = *static_cast<ShareVec<T3>*>(param3Handle);
         ShareVec<T4> & result = *static_cast<ShareVec<T4>*>(resultHandle);
 
-        Protocol protocol(*pdpi);
-        if (!protocol.invoke(param1, param2, param3, result))
+        if (!invokeProtocol<Protocol>(*pdpi, result, param1, param2, param3))
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        PROFILE_SYSCALL(c, pdpi->modelEvaluator(), name,
+        PROFILE_SYSCALL(c, *pdpi, name,
                         param1.size());
 
         return SHAREMIND_MODULE_API_0x1_OK;
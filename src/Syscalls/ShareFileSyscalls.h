@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef MOD_SHARED3P_EMU_SYSCALLS_SHAREFILESYSCALLS_H
+#define MOD_SHARED3P_EMU_SYSCALLS_SHAREFILESYSCALLS_H
+
+#include <cstring>
+#include <fcntl.h>
+#include <sharemind/module-apis/api_0x1.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "BaseSyscalls.h"
+#include "Common.h"
+#include "../Shared3pPDPI.h"
+#include "../Shared3pValueTraits.h"
+
+
+namespace sharemind {
+
+namespace {
+
+/* A read only mapping of a whole file, empty if the file could not be mapped. */
+class __attribute__ ((visibility("internal"))) ReadOnlyFileMapping {
+
+public: /* Methods: */
+
+    ReadOnlyFileMapping(const std::string & path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            m_size = static_cast<size_t>(st.st_size);
+            m_valid = true;
+            if (m_size != 0u) {
+                m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (m_data == MAP_FAILED) {
+                    m_data = nullptr;
+                    m_valid = false;
+                } else {
+                    // The file is read once from the beginning to the end:
+                    ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        ::close(fd);
+    }
+
+    ReadOnlyFileMapping(const ReadOnlyFileMapping &) = delete;
+    ReadOnlyFileMapping & operator=(const ReadOnlyFileMapping &) = delete;
+
+    ~ReadOnlyFileMapping() noexcept {
+        if (m_data)
+            ::munmap(m_data, m_size);
+    }
+
+    inline bool valid() const noexcept { return m_valid; }
+    inline const void * data() const noexcept { return m_data; }
+    inline size_t size() const noexcept { return m_size; }
+
+private: /* Fields: */
+
+    void * m_data = nullptr;
+    size_t m_size = 0u;
+    bool m_valid = false;
+
+}; /* class ReadOnlyFileMapping { */
+
+/* Share files are named by the VM, so the names must not leave the directory. */
+inline bool isShareFileName(const std::string & name) noexcept {
+    return !name.empty() && name != "." && name != ".."
+        && name.find('/') == std::string::npos;
+}
+
+} /* anonymous namespace */
+
+/**
+ * SysCall: mmap_vec<T>
+ * Stack:
+ *      0) uint64[0u]     pd index
+ * CRef: name of the file in the ShareFileDirectory of the protection domain
+ * RetVal:
+ *      0) p[0u]          vector handle
+ * Precondition:
+ *      The file holds the shares of this party in the format of set_shares.
+ * Effect:
+ *      Creates a vector of the shares in the file. The file is mapped to
+ *      memory and copied to the vector without going through VM memory.
+ */
+template <typename T>
+NAMED_SYSCALL(mmap_vec, name, args, num_args, refs, crefs, returnValue, c)
+{
+    VMHandles handles;
+    if (!SyscallArgs<1, true, 0, 1>::check(num_args, refs, crefs, returnValue) ||
+        !handles.get(c, args)) {
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    }
+
+    try {
+        Shared3pPDPI * const pdpi = static_cast<Shared3pPDPI*>(handles.pdpiHandle);
+
+        const std::string & directory = pdpi->shareFileDirectory();
+        if (directory.empty())
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        // The name may or may not be terminated by a zero byte:
+        const char * const nameData = static_cast<const char *>(crefs[0u].pData);
+        const std::string fileName(nameData, strnlen(nameData, crefs[0u].size));
+        if (!isShareFileName(fileName))
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        const ReadOnlyFileMapping file(directory + '/' + fileName);
+        typedef typename ValueTraits<T>::share_type share_type;
+        if (!file.valid() || file.size() % sizeof(share_type) != 0u)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        const size_t num_elems = file.size() / sizeof(share_type);
+        ShareVec<T> * const vec = pdpi->newVector<T>(num_elems);
+        assign_shares(*pdpi, static_cast<const share_type *>(file.data()),
+                      num_elems, *vec, 0u);
+
+        returnValue->p[0u] = vec;
+
+        PROFILE_SYSCALL(c, *pdpi, name, num_elems);
+
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (...) {
+        return catchModuleApiErrors ();
+    }
+}
+
+} /* namespace sharemind */
+
+#endif /* MOD_SHARED3P_EMU_SYSCALLS_SHAREFILESYSCALLS_H */
@@ -30,6 +30,7 @@
 #include "Protocols/FixedPoint.h"
 #include "Protocols/PrefixSumProtocols.h"
 #include "Protocols/SortingProtocol.h"
+#include "Protocols/Ternary.h"
 #include "Protocols/Unary.h"
 #include "Shared3pModule.h"
 #include "Shared3pPDPI.h"
@@ -45,6 +46,7 @@
 #include "Syscalls/MatrixShufflingSyscalls.h"
 #include "Syscalls/Meta.h"
 #include "Syscalls/ScalarProductSyscall.h"
+#include "Syscalls/ShareFileSyscalls.h"
 #include "Syscalls/SortingSyscalls.h"
 
 namespace {
@@ -130,9 +132,12 @@ SHAREMIND_MODULE_API_0x1_DEINITIALIZER(c) {
  * Define wrappers for named syscalls
  */
 NAMED_SYSCALL_WRAPPER(new_bool_vec, new_vec<s3p_bool_t>)
+NAMED_SYSCALL_WRAPPER(mmap_bool_vec, mmap_vec<s3p_bool_t>)
 NAMED_SYSCALL_WRAPPER(init_bool_vec, init_vec<s3p_bool_t>)
 NAMED_SYSCALL_WRAPPER(set_shares_bool_vec, set_shares<s3p_bool_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_bool_vec, get_shares<s3p_bool_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_bool_vec, set_shares_range<s3p_bool_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_bool_vec, get_shares_range<s3p_bool_t>)
 NAMED_SYSCALL_WRAPPER(fill_bool_vec, fill_vec<s3p_bool_t>)
 NAMED_SYSCALL_WRAPPER(assign_bool_vec, assign_vec<s3p_bool_t>)
 NAMED_SYSCALL_WRAPPER(delete_bool_vec, delete_vec<s3p_bool_t>)
@@ -168,6 +173,10 @@ NAMED_SYSCALL_WRAPPER(new_uint8_vec, new_vec<s3p_uint8_t>)
 NAMED_SYSCALL_WRAPPER(new_uint16_vec, new_vec<s3p_uint16_t>)
 NAMED_SYSCALL_WRAPPER(new_uint32_vec, new_vec<s3p_uint32_t>)
 NAMED_SYSCALL_WRAPPER(new_uint64_vec, new_vec<s3p_uint64_t>)
+NAMED_SYSCALL_WRAPPER(mmap_uint8_vec, mmap_vec<s3p_uint8_t>)
+NAMED_SYSCALL_WRAPPER(mmap_uint16_vec, mmap_vec<s3p_uint16_t>)
+NAMED_SYSCALL_WRAPPER(mmap_uint32_vec, mmap_vec<s3p_uint32_t>)
+NAMED_SYSCALL_WRAPPER(mmap_uint64_vec, mmap_vec<s3p_uint64_t>)
 NAMED_SYSCALL_WRAPPER(init_uint8_vec, init_vec<s3p_uint8_t>)
 NAMED_SYSCALL_WRAPPER(init_uint16_vec, init_vec<s3p_uint16_t>)
 NAMED_SYSCALL_WRAPPER(init_uint32_vec, init_vec<s3p_uint32_t>)
@@ -180,6 +189,14 @@ NAMED_SYSCALL_WRAPPER(get_shares_uint8_vec, get_shares<s3p_uint8_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_uint16_vec, get_shares<s3p_uint16_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_uint32_vec, get_shares<s3p_uint32_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_uint64_vec, get_shares<s3p_uint64_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_uint8_vec, set_shares_range<s3p_uint8_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_uint16_vec, set_shares_range<s3p_uint16_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_uint32_vec, set_shares_range<s3p_uint32_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_uint64_vec, set_shares_range<s3p_uint64_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_uint8_vec, get_shares_range<s3p_uint8_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_uint16_vec, get_shares_range<s3p_uint16_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_uint32_vec, get_shares_range<s3p_uint32_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_uint64_vec, get_shares_range<s3p_uint64_t>)
 NAMED_SYSCALL_WRAPPER(fill_uint8_vec, fill_vec<s3p_uint8_t>)
 NAMED_SYSCALL_WRAPPER(fill_uint16_vec, fill_vec<s3p_uint16_t>)
 NAMED_SYSCALL_WRAPPER(fill_uint32_vec, fill_vec<s3p_uint32_t>)
@@ -236,6 +253,18 @@ NAMED_SYSCALL_WRAPPER(mul_uint8_vec, binary_arith_vec<s3p_uint8_t, Multiplicatio
 NAMED_SYSCALL_WRAPPER(mul_uint16_vec, binary_arith_vec<s3p_uint16_t, MultiplicationProtocol<Shared3pPDPI>>)
 NAMED_SYSCALL_WRAPPER(mul_uint32_vec, binary_arith_vec<s3p_uint32_t, MultiplicationProtocol<Shared3pPDPI>>)
 NAMED_SYSCALL_WRAPPER(mul_uint64_vec, binary_arith_vec<s3p_uint64_t, MultiplicationProtocol<Shared3pPDPI>>)
+NAMED_SYSCALL_WRAPPER(fma_uint8_vec, ternary_vec<s3p_uint8_t, s3p_uint8_t, s3p_uint8_t, s3p_uint8_t, FusedMultiplyAddProtocol>)
+NAMED_SYSCALL_WRAPPER(sub_square_uint8_vec, binary_arith_vec<s3p_uint8_t, SubtractSquareProtocol>)
+NAMED_SYSCALL_WRAPPER(mul_sum_uint8_vec, binary_arith_vec<s3p_uint8_t, MultiplySumProtocol>)
+NAMED_SYSCALL_WRAPPER(fma_uint16_vec, ternary_vec<s3p_uint16_t, s3p_uint16_t, s3p_uint16_t, s3p_uint16_t, FusedMultiplyAddProtocol>)
+NAMED_SYSCALL_WRAPPER(sub_square_uint16_vec, binary_arith_vec<s3p_uint16_t, SubtractSquareProtocol>)
+NAMED_SYSCALL_WRAPPER(mul_sum_uint16_vec, binary_arith_vec<s3p_uint16_t, MultiplySumProtocol>)
+NAMED_SYSCALL_WRAPPER(fma_uint32_vec, ternary_vec<s3p_uint32_t, s3p_uint32_t, s3p_uint32_t, s3p_uint32_t, FusedMultiplyAddProtocol>)
+NAMED_SYSCALL_WRAPPER(sub_square_uint32_vec, binary_arith_vec<s3p_uint32_t, SubtractSquareProtocol>)
+NAMED_SYSCALL_WRAPPER(mul_sum_uint32_vec, binary_arith_vec<s3p_uint32_t, MultiplySumProtocol>)
+NAMED_SYSCALL_WRAPPER(fma_uint64_vec, ternary_vec<s3p_uint64_t, s3p_uint64_t, s3p_uint64_t, s3p_uint64_t, FusedMultiplyAddProtocol>)
+NAMED_SYSCALL_WRAPPER(sub_square_uint64_vec, binary_arith_vec<s3p_uint64_t, SubtractSquareProtocol>)
+NAMED_SYSCALL_WRAPPER(mul_sum_uint64_vec, binary_arith_vec<s3p_uint64_t, MultiplySumProtocol>)
 NAMED_SYSCALL_WRAPPER(div_uint8_vec, binary_arith_vec<s3p_uint8_t, DivisionProtocol<Shared3pPDPI>>)
 NAMED_SYSCALL_WRAPPER(div_uint16_vec, binary_arith_vec<s3p_uint16_t, DivisionProtocol<Shared3pPDPI>>)
 NAMED_SYSCALL_WRAPPER(div_uint32_vec, binary_arith_vec<s3p_uint32_t, DivisionProtocol<Shared3pPDPI>>)
@@ -416,6 +445,10 @@ NAMED_SYSCALL_WRAPPER(new_int8_vec,  new_vec<s3p_int8_t>)
 NAMED_SYSCALL_WRAPPER(new_int16_vec, new_vec<s3p_int16_t>)
 NAMED_SYSCALL_WRAPPER(new_int32_vec, new_vec<s3p_int32_t>)
 NAMED_SYSCALL_WRAPPER(new_int64_vec, new_vec<s3p_int64_t>)
+NAMED_SYSCALL_WRAPPER(mmap_int8_vec,  mmap_vec<s3p_int8_t>)
+NAMED_SYSCALL_WRAPPER(mmap_int16_vec, mmap_vec<s3p_int16_t>)
+NAMED_SYSCALL_WRAPPER(mmap_int32_vec, mmap_vec<s3p_int32_t>)
+NAMED_SYSCALL_WRAPPER(mmap_int64_vec, mmap_vec<s3p_int64_t>)
 NAMED_SYSCALL_WRAPPER(init_int8_vec,  init_vec<s3p_int8_t>)
 NAMED_SYSCALL_WRAPPER(init_int16_vec, init_vec<s3p_int16_t>)
 NAMED_SYSCALL_WRAPPER(init_int32_vec, init_vec<s3p_int32_t>)
@@ -428,6 +461,14 @@ NAMED_SYSCALL_WRAPPER(get_shares_int8_vec,  get_shares<s3p_int8_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_int16_vec, get_shares<s3p_int16_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_int32_vec, get_shares<s3p_int32_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_int64_vec, get_shares<s3p_int64_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_int8_vec,  set_shares_range<s3p_int8_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_int16_vec, set_shares_range<s3p_int16_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_int32_vec, set_shares_range<s3p_int32_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_int64_vec, set_shares_range<s3p_int64_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_int8_vec,  get_shares_range<s3p_int8_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_int16_vec, get_shares_range<s3p_int16_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_int32_vec, get_shares_range<s3p_int32_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_int64_vec, get_shares_range<s3p_int64_t>)
 NAMED_SYSCALL_WRAPPER(fill_int8_vec,  fill_vec<s3p_int8_t>)
 NAMED_SYSCALL_WRAPPER(fill_int16_vec, fill_vec<s3p_int16_t>)
 NAMED_SYSCALL_WRAPPER(fill_int32_vec, fill_vec<s3p_int32_t>)
@@ -484,6 +525,18 @@ NAMED_SYSCALL_WRAPPER(mul_int8_vec, binary_arith_vec<s3p_int8_t, MultiplicationP
 NAMED_SYSCALL_WRAPPER(mul_int16_vec, binary_arith_vec<s3p_int16_t, MultiplicationProtocol<Shared3pPDPI>>)
 NAMED_SYSCALL_WRAPPER(mul_int32_vec, binary_arith_vec<s3p_int32_t, MultiplicationProtocol<Shared3pPDPI>>)
 NAMED_SYSCALL_WRAPPER(mul_int64_vec, binary_arith_vec<s3p_int64_t, MultiplicationProtocol<Shared3pPDPI>>)
+NAMED_SYSCALL_WRAPPER(fma_int8_vec, ternary_vec<s3p_int8_t, s3p_int8_t, s3p_int8_t, s3p_int8_t, FusedMultiplyAddProtocol>)
+NAMED_SYSCALL_WRAPPER(sub_square_int8_vec, binary_arith_vec<s3p_int8_t, SubtractSquareProtocol>)
+NAMED_SYSCALL_WRAPPER(mul_sum_int8_vec, binary_arith_vec<s3p_int8_t, MultiplySumProtocol>)
+NAMED_SYSCALL_WRAPPER(fma_int16_vec, ternary_vec<s3p_int16_t, s3p_int16_t, s3p_int16_t, s3p_int16_t, FusedMultiplyAddProtocol>)
+NAMED_SYSCALL_WRAPPER(sub_square_int16_vec, binary_arith_vec<s3p_int16_t, SubtractSquareProtocol>)
+NAMED_SYSCALL_WRAPPER(mul_sum_int16_vec, binary_arith_vec<s3p_int16_t, MultiplySumProtocol>)
+NAMED_SYSCALL_WRAPPER(fma_int32_vec, ternary_vec<s3p_int32_t, s3p_int32_t, s3p_int32_t, s3p_int32_t, FusedMultiplyAddProtocol>)
+NAMED_SYSCALL_WRAPPER(sub_square_int32_vec, binary_arith_vec<s3p_int32_t, SubtractSquareProtocol>)
+NAMED_SYSCALL_WRAPPER(mul_sum_int32_vec, binary_arith_vec<s3p_int32_t, MultiplySumProtocol>)
+NAMED_SYSCALL_WRAPPER(fma_int64_vec, ternary_vec<s3p_int64_t, s3p_int64_t, s3p_int64_t, s3p_int64_t, FusedMultiplyAddProtocol>)
+NAMED_SYSCALL_WRAPPER(sub_square_int64_vec, binary_arith_vec<s3p_int64_t, SubtractSquareProtocol>)
+NAMED_SYSCALL_WRAPPER(mul_sum_int64_vec, binary_arith_vec<s3p_int64_t, MultiplySumProtocol>)
 NAMED_SYSCALL_WRAPPER(mulc_int8_vec, binary_arith_public_vec<s3p_int8_t, MultiplicationProtocol<Shared3pPDPI>>)
 NAMED_SYSCALL_WRAPPER(mulc_int16_vec, binary_arith_public_vec<s3p_int16_t, MultiplicationProtocol<Shared3pPDPI>>)
 NAMED_SYSCALL_WRAPPER(mulc_int32_vec, binary_arith_public_vec<s3p_int32_t, MultiplicationProtocol<Shared3pPDPI>>)
@@ -592,6 +645,10 @@ NAMED_SYSCALL_WRAPPER(new_xor_uint8_vec,  new_vec<s3p_xor_uint8_t>)
 NAMED_SYSCALL_WRAPPER(new_xor_uint16_vec, new_vec<s3p_xor_uint16_t>)
 NAMED_SYSCALL_WRAPPER(new_xor_uint32_vec, new_vec<s3p_xor_uint32_t>)
 NAMED_SYSCALL_WRAPPER(new_xor_uint64_vec, new_vec<s3p_xor_uint64_t>)
+NAMED_SYSCALL_WRAPPER(mmap_xor_uint8_vec,  mmap_vec<s3p_xor_uint8_t>)
+NAMED_SYSCALL_WRAPPER(mmap_xor_uint16_vec, mmap_vec<s3p_xor_uint16_t>)
+NAMED_SYSCALL_WRAPPER(mmap_xor_uint32_vec, mmap_vec<s3p_xor_uint32_t>)
+NAMED_SYSCALL_WRAPPER(mmap_xor_uint64_vec, mmap_vec<s3p_xor_uint64_t>)
 NAMED_SYSCALL_WRAPPER(init_xor_uint8_vec,  init_vec<s3p_xor_uint8_t>)
 NAMED_SYSCALL_WRAPPER(init_xor_uint16_vec, init_vec<s3p_xor_uint16_t>)
 NAMED_SYSCALL_WRAPPER(init_xor_uint32_vec, init_vec<s3p_xor_uint32_t>)
@@ -604,6 +661,14 @@ NAMED_SYSCALL_WRAPPER(get_shares_xor_uint8_vec,  get_shares<s3p_xor_uint8_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_xor_uint16_vec, get_shares<s3p_xor_uint16_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_xor_uint32_vec, get_shares<s3p_xor_uint32_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_xor_uint64_vec, get_shares<s3p_xor_uint64_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_xor_uint8_vec,  set_shares_range<s3p_xor_uint8_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_xor_uint16_vec, set_shares_range<s3p_xor_uint16_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_xor_uint32_vec, set_shares_range<s3p_xor_uint32_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_xor_uint64_vec, set_shares_range<s3p_xor_uint64_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_xor_uint8_vec,  get_shares_range<s3p_xor_uint8_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_xor_uint16_vec, get_shares_range<s3p_xor_uint16_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_xor_uint32_vec, get_shares_range<s3p_xor_uint32_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_xor_uint64_vec, get_shares_range<s3p_xor_uint64_t>)
 NAMED_SYSCALL_WRAPPER(fill_xor_uint8_vec,  fill_vec<s3p_xor_uint8_t>)
 NAMED_SYSCALL_WRAPPER(fill_xor_uint16_vec, fill_vec<s3p_xor_uint16_t>)
 NAMED_SYSCALL_WRAPPER(fill_xor_uint32_vec, fill_vec<s3p_xor_uint32_t>)
@@ -770,12 +835,18 @@ NAMED_SYSCALL_WRAPPER(matshufinv_xor_uint32_vec, matrix_shuffle<s3p_xor_uint32_t
 NAMED_SYSCALL_WRAPPER(matshufinv_xor_uint64_vec, matrix_shuffle<s3p_xor_uint64_t, true, true>)
 NAMED_SYSCALL_WRAPPER(new_float32_vec, new_vec<s3p_float32_t>)
 NAMED_SYSCALL_WRAPPER(new_float64_vec, new_vec<s3p_float64_t>)
+NAMED_SYSCALL_WRAPPER(mmap_float32_vec, mmap_vec<s3p_float32_t>)
+NAMED_SYSCALL_WRAPPER(mmap_float64_vec, mmap_vec<s3p_float64_t>)
 NAMED_SYSCALL_WRAPPER(init_float32_vec, init_vec<s3p_float32_t>)
 NAMED_SYSCALL_WRAPPER(init_float64_vec, init_vec<s3p_float64_t>)
 NAMED_SYSCALL_WRAPPER(set_shares_float32_vec, set_shares<s3p_float32_t>)
 NAMED_SYSCALL_WRAPPER(set_shares_float64_vec, set_shares<s3p_float64_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_float32_vec, get_shares<s3p_float32_t>)
 NAMED_SYSCALL_WRAPPER(get_shares_float64_vec, get_shares<s3p_float64_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_float32_vec, set_shares_range<s3p_float32_t>)
+NAMED_SYSCALL_WRAPPER(set_shares_range_float64_vec, set_shares_range<s3p_float64_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_float32_vec, get_shares_range<s3p_float32_t>)
+NAMED_SYSCALL_WRAPPER(get_shares_range_float64_vec, get_shares_range<s3p_float64_t>)
 NAMED_SYSCALL_WRAPPER(fill_float32_vec, fill_vec<s3p_float32_t>)
 NAMED_SYSCALL_WRAPPER(fill_float64_vec, fill_vec<s3p_float64_t>)
 NAMED_SYSCALL_WRAPPER(assign_float32_vec, assign_vec<s3p_float32_t>)
@@ -802,6 +873,12 @@ NAMED_SYSCALL_WRAPPER(sub_float32_vec, binary_arith_vec<s3p_float32_t, Subtracti
 NAMED_SYSCALL_WRAPPER(sub_float64_vec, binary_arith_vec<s3p_float64_t, SubtractionProtocol<Shared3pPDPI>>)
 NAMED_SYSCALL_WRAPPER(mul_float32_vec, binary_arith_vec<s3p_float32_t, MultiplicationProtocol<Shared3pPDPI>>)
 NAMED_SYSCALL_WRAPPER(mul_float64_vec, binary_arith_vec<s3p_float64_t, MultiplicationProtocol<Shared3pPDPI>>)
+NAMED_SYSCALL_WRAPPER(fma_float32_vec, ternary_vec<s3p_float32_t, s3p_float32_t, s3p_float32_t, s3p_float32_t, FusedMultiplyAddProtocol>)
+NAMED_SYSCALL_WRAPPER(sub_square_float32_vec, binary_arith_vec<s3p_float32_t, SubtractSquareProtocol>)
+NAMED_SYSCALL_WRAPPER(mul_sum_float32_vec, binary_arith_vec<s3p_float32_t, MultiplySumProtocol>)
+NAMED_SYSCALL_WRAPPER(fma_float64_vec, ternary_vec<s3p_float64_t, s3p_float64_t, s3p_float64_t, s3p_float64_t, FusedMultiplyAddProtocol>)
+NAMED_SYSCALL_WRAPPER(sub_square_float64_vec, binary_arith_vec<s3p_float64_t, SubtractSquareProtocol>)
+NAMED_SYSCALL_WRAPPER(mul_sum_float64_vec, binary_arith_vec<s3p_float64_t, MultiplySumProtocol>)
 NAMED_SYSCALL_WRAPPER(mul_fix32_vec, binary_arith_vec<s3p_uint32_t, FixMultiplicationProtocol>)
 NAMED_SYSCALL_WRAPPER(mul_fix64_vec, binary_arith_vec<s3p_uint64_t, FixMultiplicationProtocol>)
 NAMED_SYSCALL_WRAPPER(inv_float32_vec, unary_arith_vec<s3p_float32_t, FloatInverseProtocol>)
@@ -988,9 +1065,12 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
 
    // Variable management
     NAMED_SYSCALL_DEFINITION("shared3p::new_bool_vec", new_bool_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_bool_vec", mmap_bool_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_bool_vec", init_bool_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_bool_vec", set_shares_bool_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_bool_vec", get_shares_bool_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_bool_vec", set_shares_range_bool_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_bool_vec", get_shares_range_bool_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_bool_vec", fill_bool_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::assign_bool_vec", assign_bool_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::delete_bool_vec", delete_bool_vec)
@@ -1044,6 +1124,10 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
   , NAMED_SYSCALL_DEFINITION("shared3p::new_uint16_vec", new_uint16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::new_uint32_vec", new_uint32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::new_uint64_vec", new_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_uint8_vec", mmap_uint8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_uint16_vec", mmap_uint16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_uint32_vec", mmap_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_uint64_vec", mmap_uint64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_uint8_vec", init_uint8_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_uint16_vec", init_uint16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_uint32_vec", init_uint32_vec)
@@ -1056,6 +1140,14 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_uint16_vec", get_shares_uint16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_uint32_vec", get_shares_uint32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_uint64_vec", get_shares_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_uint8_vec", set_shares_range_uint8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_uint16_vec", set_shares_range_uint16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_uint32_vec", set_shares_range_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_uint64_vec", set_shares_range_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_uint8_vec", get_shares_range_uint8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_uint16_vec", get_shares_range_uint16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_uint32_vec", get_shares_range_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_uint64_vec", get_shares_range_uint64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_uint8_vec", fill_uint8_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_uint16_vec", fill_uint16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_uint32_vec", fill_uint32_vec)
@@ -1114,6 +1206,18 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
   , NAMED_SYSCALL_DEFINITION("shared3p::mul_uint16_vec", mul_uint16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::mul_uint32_vec", mul_uint32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::mul_uint64_vec", mul_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::fma_uint8_vec",  fma_uint8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::sub_square_uint8_vec",  sub_square_uint8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mul_sum_uint8_vec",  mul_sum_uint8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::fma_uint16_vec", fma_uint16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::sub_square_uint16_vec", sub_square_uint16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mul_sum_uint16_vec", mul_sum_uint16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::fma_uint32_vec", fma_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::sub_square_uint32_vec", sub_square_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mul_sum_uint32_vec", mul_sum_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::fma_uint64_vec", fma_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::sub_square_uint64_vec", sub_square_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mul_sum_uint64_vec", mul_sum_uint64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::div_uint8_vec",  div_uint8_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::div_uint16_vec", div_uint16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::div_uint32_vec", div_uint32_vec)
@@ -1252,6 +1356,8 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
     // Fixed-point numbers
   , NAMED_SYSCALL_DEFINITION("shared3p::new_fix32_vec", new_uint32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::new_fix64_vec", new_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_fix32_vec", mmap_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_fix64_vec", mmap_uint64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::delete_fix32_vec", delete_uint32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::delete_fix64_vec", delete_uint64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::assign_fix32_vec", assign_uint32_vec)
@@ -1260,6 +1366,10 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
   , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_fix64_vec", set_shares_uint64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_fix32_vec", get_shares_uint32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_fix64_vec", get_shares_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_fix32_vec", set_shares_range_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_fix64_vec", set_shares_range_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_fix32_vec", get_shares_range_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_fix64_vec", get_shares_range_uint64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_type_size_fix32", get_type_size_uint32)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_type_size_fix64", get_type_size_uint64)
   , NAMED_SYSCALL_DEFINITION("shared3p::load_fix32_vec", load_uint32_vec)
@@ -1362,6 +1472,10 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
   , NAMED_SYSCALL_DEFINITION("shared3p::new_int16_vec", new_int16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::new_int32_vec", new_int32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::new_int64_vec", new_int64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_int8_vec", mmap_int8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_int16_vec", mmap_int16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_int32_vec", mmap_int32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_int64_vec", mmap_int64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_int8_vec", init_int8_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_int16_vec", init_int16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_int32_vec", init_int32_vec)
@@ -1374,6 +1488,14 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_int16_vec", get_shares_int16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_int32_vec", get_shares_int32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_int64_vec", get_shares_int64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_int8_vec", set_shares_range_int8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_int16_vec", set_shares_range_int16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_int32_vec", set_shares_range_int32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_int64_vec", set_shares_range_int64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_int8_vec", get_shares_range_int8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_int16_vec", get_shares_range_int16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_int32_vec", get_shares_range_int32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_int64_vec", get_shares_range_int64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_int8_vec", fill_int8_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_int16_vec", fill_int16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_int32_vec", fill_int32_vec)
@@ -1431,6 +1553,18 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
   , NAMED_SYSCALL_DEFINITION("shared3p::mul_int16_vec", mul_int16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::mul_int32_vec", mul_int32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::mul_int64_vec", mul_int64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::fma_int8_vec",  fma_int8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::sub_square_int8_vec",  sub_square_int8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mul_sum_int8_vec",  mul_sum_int8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::fma_int16_vec", fma_int16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::sub_square_int16_vec", sub_square_int16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mul_sum_int16_vec", mul_sum_int16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::fma_int32_vec", fma_int32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::sub_square_int32_vec", sub_square_int32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mul_sum_int32_vec", mul_sum_int32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::fma_int64_vec", fma_int64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::sub_square_int64_vec", sub_square_int64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mul_sum_int64_vec", mul_sum_int64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::mulc_int8_vec",  mulc_int8_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::mulc_int16_vec", mulc_int16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::mulc_int32_vec", mulc_int32_vec)
@@ -1558,6 +1692,10 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
   , NAMED_SYSCALL_DEFINITION("shared3p::new_xor_uint16_vec", new_xor_uint16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::new_xor_uint32_vec", new_xor_uint32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::new_xor_uint64_vec", new_xor_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_xor_uint8_vec", mmap_xor_uint8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_xor_uint16_vec", mmap_xor_uint16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_xor_uint32_vec", mmap_xor_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_xor_uint64_vec", mmap_xor_uint64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_xor_uint8_vec", init_xor_uint8_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_xor_uint16_vec", init_xor_uint16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_xor_uint32_vec", init_xor_uint32_vec)
@@ -1570,6 +1708,14 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_xor_uint16_vec", get_shares_xor_uint16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_xor_uint32_vec", get_shares_xor_uint32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_xor_uint64_vec", get_shares_xor_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_xor_uint8_vec", set_shares_range_xor_uint8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_xor_uint16_vec", set_shares_range_xor_uint16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_xor_uint32_vec", set_shares_range_xor_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_xor_uint64_vec", set_shares_range_xor_uint64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_xor_uint8_vec", get_shares_range_xor_uint8_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_xor_uint16_vec", get_shares_range_xor_uint16_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_xor_uint32_vec", get_shares_range_xor_uint32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_xor_uint64_vec", get_shares_range_xor_uint64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_xor_uint8_vec", fill_xor_uint8_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_xor_uint16_vec", fill_xor_uint16_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_xor_uint32_vec", fill_xor_uint32_vec)
@@ -1760,12 +1906,18 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
    // Variable management
   , NAMED_SYSCALL_DEFINITION("shared3p::new_float32_vec", new_float32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::new_float64_vec", new_float64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_float32_vec", mmap_float32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mmap_float64_vec", mmap_float64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_float32_vec", init_float32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::init_float64_vec", init_float64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_float32_vec", set_shares_float32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_float64_vec", set_shares_float64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_float32_vec", get_shares_float32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_float64_vec", get_shares_float64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_float32_vec", set_shares_range_float32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::set_shares_range_float64_vec", set_shares_range_float64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_float32_vec", get_shares_range_float32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::get_shares_range_float64_vec", get_shares_range_float64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_float32_vec", fill_float32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::fill_float64_vec", fill_float64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::assign_float32_vec", assign_float32_vec)
@@ -1794,6 +1946,12 @@ SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
   , NAMED_SYSCALL_DEFINITION("shared3p::sub_float64_vec", sub_float64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::mul_float32_vec", mul_float32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::mul_float64_vec", mul_float64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::fma_float32_vec", fma_float32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::sub_square_float32_vec", sub_square_float32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mul_sum_float32_vec", mul_sum_float32_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::fma_float64_vec", fma_float64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::sub_square_float64_vec", sub_square_float64_vec)
+  , NAMED_SYSCALL_DEFINITION("shared3p::mul_sum_float64_vec", mul_sum_float64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::inv_float32_vec", inv_float32_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::inv_float64_vec", inv_float64_vec)
   , NAMED_SYSCALL_DEFINITION("shared3p::div_float32_vec", div_float32_vec)
@@ -2036,7 +2194,11 @@ SHAREMIND_MODULE_API_0x1_PDPI_SHUTDOWN(shared3p_emu_PDPI_shutdown, w) {
 
     static_assert(std::is_nothrow_destructible<sharemind::Shared3pPDPI>::value,
                   "");
-    delete static_cast<sharemind::Shared3pPDPI *>(w->pdProcessHandle);
+    sharemind::Shared3pPDPI * const pdpi =
+            static_cast<sharemind::Shared3pPDPI *>(w->pdProcessHandle);
+    pdpi->logStatistics();
+    pdpi->writeSyscallStatistics();
+    delete pdpi;
     #ifndef NDEBUG
     w->pdProcessHandle = nullptr; // Not needed, but may help debugging.
     #endif
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+/*
+ * Checks the integer fma, sub_square and mul_sum protocols against products
+ * computed modulo 2^64, with operands near the limits of their types where
+ * the products overflow int.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <LogHard/Backend.h>
+#include <LogHard/Logger.h>
+#include <LogHard/StdAppender.h>
+#include <memory>
+#include <vector>
+#include "../src/Protocols/Binary.h"
+#include "../src/Protocols/Ternary.h"
+#include "../src/Shared3pModule.h"
+#include "../src/Shared3pPD.h"
+#include "../src/Shared3pPDPI.h"
+
+
+namespace sharemind {
+
+namespace {
+
+template <typename T>
+using Share = typename ValueTraits<T>::share_type;
+
+template <typename T>
+void assign(ShareVec<T> & vec, const std::vector<Share<T> > & values) {
+    for (size_t i = 0u; i < values.size(); ++i)
+        vec[i] = values[i];
+}
+
+/* The values of S near 0, its minimum and its maximum: */
+template <typename S>
+std::vector<S> edgeValues() {
+    std::vector<S> values;
+    for (int d = 0; d < 4; ++d) {
+        values.push_back(S(std::numeric_limits<S>::max() - d));
+        values.push_back(S(std::numeric_limits<S>::min() + d));
+        values.push_back(S(d));
+    }
+    return values;
+}
+
+template <typename T>
+bool testFusedArithmetic(Shared3pPDPI & pdpi, const char * typeName) {
+    using S = Share<T>;
+
+    // All pairs and triples of the edge values:
+    const std::vector<S> edges = edgeValues<S>();
+    std::vector<S> a, b, c;
+    for (const S x : edges)
+        for (const S y : edges)
+            for (const S z : edges) {
+                a.push_back(x);
+                b.push_back(y);
+                c.push_back(z);
+            }
+
+    ShareVec<T> va(a.size());
+    ShareVec<T> vb(b.size());
+    ShareVec<T> vc(c.size());
+    assign(va, a);
+    assign(vb, b);
+    assign(vc, c);
+    ShareVec<T> fma(a.size());
+    ShareVec<T> subSquare(a.size());
+    ShareVec<T> mulSum(1u);
+
+    FusedMultiplyAddProtocol(pdpi).invoke(va, vb, vc, fma);
+    SubtractSquareProtocol(pdpi).invoke(va, vb, subSquare);
+    MultiplySumProtocol(pdpi).invoke(va, vb, mulSum);
+
+    size_t failures = 0u;
+    uint64_t sum = 0u;
+    for (size_t i = 0u; i < a.size(); ++i) {
+        const uint64_t x = uint64_t(a[i]);
+        const uint64_t y = uint64_t(b[i]);
+        const uint64_t z = uint64_t(c[i]);
+        failures += S(fma[i]) != S(x * y + z);
+        failures += S(subSquare[i]) != S((x - y) * (x - y));
+        sum += x * y;
+    }
+    failures += S(mulSum[0u]) != S(sum);
+
+    if (failures != 0u)
+        std::cerr << typeName << ": " << failures << " wrong results."
+                  << std::endl;
+    return failures == 0u;
+}
+
+} /* anonymous namespace */
+
+} /* namespace sharemind { */
+
+int main() {
+    using namespace sharemind;
+
+    auto backend(std::make_shared<LogHard::Backend>());
+    backend->addAppender(std::make_shared<LogHard::StdAppender>());
+    const LogHard::Logger logger(backend);
+
+    try {
+        Shared3pModule module(logger);
+        Shared3pPD pd("shared3p", SHARED3P_EMU_TEST_CONFIGURATION, module);
+        Shared3pPDPI pdpi(pd);
+
+        bool ok = true;
+        ok &= testFusedArithmetic<s3p_uint8_t>(pdpi, "uint8");
+        ok &= testFusedArithmetic<s3p_uint16_t>(pdpi, "uint16");
+        ok &= testFusedArithmetic<s3p_uint32_t>(pdpi, "uint32");
+        ok &= testFusedArithmetic<s3p_uint64_t>(pdpi, "uint64");
+        ok &= testFusedArithmetic<s3p_int8_t>(pdpi, "int8");
+        ok &= testFusedArithmetic<s3p_int16_t>(pdpi, "int16");
+        ok &= testFusedArithmetic<s3p_int32_t>(pdpi, "int32");
+        ok &= testFusedArithmetic<s3p_int64_t>(pdpi, "int64");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (...) {
+        logger.printCurrentException();
+        return EXIT_FAILURE;
+    }
+}
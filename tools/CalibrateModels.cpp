@@ -0,0 +1,460 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+/*
+ * Fits the time models of the syscalls to timing traces of a real shared3p
+ * deployment and writes a new model file for the ModelEvaluatorConfiguration
+ * of the protection domain.
+ *
+ * The traces are CSV files with a header line. The columns "syscall" and
+ * "size" are required, the time is read from the first of "microseconds",
+ * "milliseconds", "seconds" or "ns_per_call" present. Rows with a "status"
+ * column other than "ok" are ignored, so the output of shared3p_emu_benchmark
+ * can be used as well.
+ *
+ * Every syscall gets the same form as the hand written models,
+ * max(a, b * S ^ c) * 1000 with a and b in milliseconds. The fit minimizes
+ * the absolute error of the logarithm of the time, which is robust to the
+ * outliers of a loaded cluster: the sizes are split into a constant part and
+ * a power law part, the constant is the median of the constant part and the
+ * power law is fitted to the medians of the rest with the Theil-Sen
+ * estimator. The split with the smallest error wins.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+constexpr char const SYSCALL_PREFIX[] = "shared3p::";
+constexpr char const TIME_MODEL_SECTION[] = "[TimeModel]";
+
+struct Sample {
+    double size;
+    double milliseconds;
+};
+
+struct Model {
+    double a;
+    double b;
+    double c;
+    bool constant;
+
+    inline double evaluate(double size) const noexcept
+    { return constant ? a : std::max(a, b * std::pow(size, c)); }
+
+    std::string expression() const {
+        std::ostringstream oss;
+        oss << std::setprecision(15);
+        if (constant) {
+            oss << a << " * 1000";
+        } else {
+            oss << "max(" << a << ", " << b << " * S ^ " << c << ") * 1000";
+        }
+        return oss.str();
+    }
+};
+
+struct Fit {
+    Model model;
+    size_t samples;
+    size_t sizes;
+    double logR2;
+    double medianRelativeError;
+    double maxRelativeError;
+};
+
+double median(std::vector<double> values) {
+    assert(!values.empty());
+    const size_t mid = values.size() / 2u;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    const double upper = values[mid];
+    if (values.size() % 2u)
+        return upper;
+
+    const double lower =
+            *std::max_element(values.begin(), values.begin() + mid);
+    return (lower + upper) / 2.0;
+}
+
+std::vector<std::string> splitCsvLine(const std::string & line) {
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream iss(line);
+    while (std::getline(iss, field, ','))
+        fields.push_back(field);
+    if (!line.empty() && line.back() == ',')
+        fields.emplace_back();
+    return fields;
+}
+
+/** Reads the samples of a trace file into the per syscall sample lists. */
+bool readTraces(const std::string & filename,
+                std::map<std::string, std::vector<Sample> > & samples)
+{
+    std::ifstream in(filename);
+    std::string line;
+    if (!in || !std::getline(in, line)) {
+        std::cerr << filename << ": failed to read the header" << std::endl;
+        return false;
+    }
+
+    const std::vector<std::string> header = splitCsvLine(line);
+    auto column = [&header](const char * name) -> size_t {
+        const auto it = std::find(header.begin(), header.end(), name);
+        return it == header.end() ? header.size()
+                                  : static_cast<size_t>(it - header.begin());
+    };
+
+    const size_t syscallColumn = column("syscall");
+    const size_t sizeColumn = column("size");
+    const size_t statusColumn = column("status");
+    size_t timeColumn = header.size();
+    double toMilliseconds = 0.0;
+    for (const auto & unit : { std::make_pair("microseconds", 1e-3),
+                               std::make_pair("milliseconds", 1.0),
+                               std::make_pair("seconds", 1e3),
+                               std::make_pair("ns_per_call", 1e-6) })
+    {
+        timeColumn = column(unit.first);
+        if (timeColumn != header.size()) {
+            toMilliseconds = unit.second;
+            break;
+        }
+    }
+
+    if (syscallColumn == header.size() || sizeColumn == header.size()
+        || timeColumn == header.size())
+    {
+        std::cerr << filename << ": missing the syscall, size or time column"
+                  << std::endl;
+        return false;
+    }
+
+    size_t lineNumber = 1u;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty())
+            continue;
+
+        const std::vector<std::string> fields = splitCsvLine(line);
+        if (fields.size() != header.size()) {
+            std::cerr << filename << ':' << lineNumber
+                      << ": wrong number of fields" << std::endl;
+            return false;
+        }
+
+        if (statusColumn != header.size() && fields[statusColumn] != "ok")
+            continue;
+
+        char * sizeEnd;
+        char * timeEnd;
+        const double size = std::strtod(fields[sizeColumn].c_str(), &sizeEnd);
+        const double time = std::strtod(fields[timeColumn].c_str(), &timeEnd);
+        if (*sizeEnd != '\0' || *timeEnd != '\0') {
+            std::cerr << filename << ':' << lineNumber
+                      << ": malformed size or time" << std::endl;
+            return false;
+        }
+
+        // Logarithms are taken of both:
+        if (!(size > 0.0) || !(time > 0.0))
+            continue;
+
+        std::string name(fields[syscallColumn]);
+        if (name.compare(0u, sizeof(SYSCALL_PREFIX) - 1u, SYSCALL_PREFIX) != 0)
+            name.insert(0u, SYSCALL_PREFIX);
+        samples[name].push_back({ size, time * toMilliseconds });
+    }
+
+    return true;
+}
+
+/** \returns the sum of the absolute errors of the logarithms. */
+double logError(const Model & model, const std::vector<Sample> & samples) {
+    double error = 0.0;
+    for (const Sample & s : samples)
+        error += std::fabs(std::log(model.evaluate(s.size))
+                           - std::log(s.milliseconds));
+    return error;
+}
+
+/**
+ * Fits log(t) = log(b) + c * log(S) to the given points of the log-log plane
+ * with the Theil-Sen estimator.
+ */
+void theilSen(const std::vector<double> & logSizes,
+              const std::vector<double> & logTimes,
+              size_t begin,
+              double & b,
+              double & c)
+{
+    std::vector<double> slopes;
+    for (size_t i = begin; i < logSizes.size(); ++i)
+        for (size_t j = i + 1u; j < logSizes.size(); ++j)
+            slopes.push_back((logTimes[j] - logTimes[i])
+                             / (logSizes[j] - logSizes[i]));
+    c = median(slopes);
+
+    std::vector<double> intercepts;
+    for (size_t i = begin; i < logSizes.size(); ++i)
+        intercepts.push_back(logTimes[i] - c * logSizes[i]);
+    b = std::exp(median(intercepts));
+}
+
+Fit fit(std::vector<Sample> samples) {
+    std::sort(samples.begin(), samples.end(),
+              [](const Sample & x, const Sample & y)
+              { return x.size < y.size; });
+
+    // The median time of every distinct size:
+    std::vector<double> sizes;
+    std::vector<double> medians;
+    for (size_t i = 0u; i < samples.size();) {
+        std::vector<double> times;
+        size_t j = i;
+        for (; j < samples.size() && samples[j].size == samples[i].size; ++j)
+            times.push_back(samples[j].milliseconds);
+        sizes.push_back(samples[i].size);
+        medians.push_back(median(std::move(times)));
+        i = j;
+    }
+
+    std::vector<double> logSizes;
+    std::vector<double> logTimes;
+    for (size_t i = 0u; i < sizes.size(); ++i) {
+        logSizes.push_back(std::log(sizes[i]));
+        logTimes.push_back(std::log(medians[i]));
+    }
+
+    // All sizes in the constant part:
+    Model best{ median(medians), 0.0, 1.0, true };
+    double bestError = logError(best, samples);
+
+    // The first k sizes in the constant part, at least two in the power law:
+    for (size_t k = 0u; k + 2u <= sizes.size(); ++k) {
+        Model model{ 0.0, 0.0, 0.0, false };
+        theilSen(logSizes, logTimes, k, model.b, model.c);
+        model.a = k ? median(std::vector<double>(medians.begin(),
+                                                 medians.begin() + k))
+                    : model.b * std::pow(sizes.front(), model.c);
+
+        const double error = logError(model, samples);
+        if (error < bestError) {
+            best = model;
+            bestError = error;
+        }
+    }
+
+    // Quality of the fit:
+    double meanLog = 0.0;
+    for (const Sample & s : samples)
+        meanLog += std::log(s.milliseconds);
+    meanLog /= samples.size();
+
+    double residual = 0.0;
+    double total = 0.0;
+    double maxRelative = 0.0;
+    std::vector<double> relative;
+    for (const Sample & s : samples) {
+        const double predicted = best.evaluate(s.size);
+        const double d = std::log(predicted) - std::log(s.milliseconds);
+        residual += d * d;
+        total += (std::log(s.milliseconds) - meanLog)
+                 * (std::log(s.milliseconds) - meanLog);
+        relative.push_back(std::fabs(predicted - s.milliseconds)
+                           / s.milliseconds);
+        maxRelative = std::max(maxRelative, relative.back());
+    }
+
+    return { best,
+             samples.size(),
+             sizes.size(),
+             total > 0.0 ? 1.0 - residual / total : 1.0,
+             median(std::move(relative)),
+             maxRelative };
+}
+
+/**
+ * Copies the base model file to the output, replacing the models of the
+ * fitted syscalls and adding the models of new ones to the end of the
+ * TimeModel section.
+ */
+bool writeModels(const std::string & baseFilename,
+                 const std::string & outputFilename,
+                 const std::map<std::string, Fit> & fits)
+{
+    std::vector<std::string> lines;
+    if (!baseFilename.empty()) {
+        std::ifstream in(baseFilename);
+        if (!in) {
+            std::cerr << baseFilename << ": failed to read" << std::endl;
+            return false;
+        }
+
+        for (std::string line; std::getline(in, line);)
+            lines.push_back(line);
+    }
+
+    if (lines.empty())
+        lines = { "[BaseVariable]", "InputSize = S", "", TIME_MODEL_SECTION };
+
+    std::map<std::string, Fit> remaining(fits);
+    bool inTimeModel = false;
+    size_t timeModelEnd = lines.size();
+    for (size_t i = 0u; i < lines.size(); ++i) {
+        std::string & line = lines[i];
+        if (!line.empty() && line.front() == '[') {
+            if (inTimeModel && timeModelEnd == lines.size())
+                timeModelEnd = i;
+            inTimeModel = line == TIME_MODEL_SECTION;
+            continue;
+        }
+
+        const size_t eq = line.find(" = ");
+        if (!inTimeModel || eq == std::string::npos)
+            continue;
+
+        const auto it = remaining.find(line.substr(0u, eq));
+        if (it == remaining.end())
+            continue;
+
+        line = it->first + " = " + it->second.model.expression();
+        remaining.erase(it);
+    }
+
+    // Keep the blank lines separating the section from the next one:
+    while (timeModelEnd > 0u && lines[timeModelEnd - 1u].empty())
+        --timeModelEnd;
+
+    std::vector<std::string> added;
+    for (const auto & f : remaining)
+        added.push_back(f.first + " = " + f.second.model.expression());
+    lines.insert(lines.begin() + static_cast<std::ptrdiff_t>(timeModelEnd),
+                 added.begin(),
+                 added.end());
+
+    std::ofstream out(outputFilename);
+    for (const std::string & line : lines)
+        out << line << '\n';
+    out.flush();
+    if (!out) {
+        std::cerr << outputFilename << ": failed to write" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void writeReport(std::ostream & os, const std::map<std::string, Fit> & fits) {
+    os << "syscall,samples,sizes,a_ms,b_ms,c,log_r2,median_relative_error,"
+          "max_relative_error\n"
+       << std::setprecision(6);
+    for (const auto & f : fits) {
+        const Fit & fit = f.second;
+        os << f.first << ',' << fit.samples << ',' << fit.sizes << ','
+           << fit.model.a << ',' << fit.model.b << ',' << fit.model.c << ','
+           << fit.logR2 << ',' << fit.medianRelativeError << ','
+           << fit.maxRelativeError << '\n';
+    }
+}
+
+void usage(const char * program) {
+    std::cerr
+        << "Usage: " << program << " [options] TRACE.csv...\n"
+           "  --models FILE       model file whose other syscalls and "
+           "sections are kept\n"
+           "  --output FILE       the new model file (required)\n"
+           "  --report FILE       fit quality per syscall as CSV (stderr)\n"
+           "  --min-samples N     syscalls with fewer samples keep their "
+           "model (3)\n";
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char * argv[]) {
+    std::string baseFilename;
+    std::string outputFilename;
+    std::string reportFilename;
+    size_t minSamples = 3u;
+    std::vector<std::string> traces;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (arg.compare(0u, 2u, "--") != 0) {
+            traces.push_back(arg);
+        } else if (i + 1 >= argc) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        } else if (arg == "--models") {
+            baseFilename = argv[++i];
+        } else if (arg == "--output") {
+            outputFilename = argv[++i];
+        } else if (arg == "--report") {
+            reportFilename = argv[++i];
+        } else if (arg == "--min-samples") {
+            minSamples = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (traces.empty() || outputFilename.empty()) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::map<std::string, std::vector<Sample> > samples;
+    for (const std::string & trace : traces)
+        if (!readTraces(trace, samples))
+            return EXIT_FAILURE;
+
+    std::map<std::string, Fit> fits;
+    for (const auto & s : samples)
+        if (s.second.size() >= std::max(minSamples, size_t(1u)))
+            fits.emplace(s.first, fit(s.second));
+
+    if (!writeModels(baseFilename, outputFilename, fits))
+        return EXIT_FAILURE;
+
+    if (reportFilename.empty()) {
+        writeReport(std::cerr, fits);
+    } else {
+        std::ofstream report(reportFilename);
+        writeReport(report, fits);
+        if (!report) {
+            std::cerr << reportFilename << ": failed to write" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}